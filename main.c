@@ -1,36 +1,176 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <math.h>
 #include <time.h>
+#include <stdint.h>
+#include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SOM_X86 1
+#include <immintrin.h>
+#endif
+
+
+/*------------------------CONSTANTES------------------------*/
+
+/** Alignment (in bytes) of the codebook weight block: one cache line, also wide enough for AVX-512. */
+#define ALIGNEMENT_CACHE 64
+
+/** Number of neurons per cache block of the mini-batch distance computation (`distancesLot`). */
+#define BLOC_NEURONES 128
+
+/** Number of dimensions per cache block of the mini-batch distance computation (`distancesLot`). */
+#define BLOC_DIMENSIONS 256
+
+/** Magic number at the start of a binary dataset file (see `ecrireDatasetBinaire`). */
+#define MAGIE_DATASET "SOMD"
+
+/** Version of the binary dataset format. */
+#define VERSION_DATASET 1
+
+/** Magic number at the start of a trained model file (see `ecrireModele`). */
+#define MAGIE_MODELE "SOMM"
+
+/** Version of the trained model format. */
+#define VERSION_MODELE 1
+
+/** Largest neighborhood radius used by the training schedule of `rapprochement`. */
+#define RAYON_VOISINAGE_MAX 3
+
+/** Number of dimensions summed between two checks of the early-abandoning BMU scan (`rechercheBMUAbandon`). */
+#define BLOC_ABANDON 32
+
+/** Seed of the random projection of the two-stage BMU search (`creerEsquisse`). */
+#define GRAINE_ESQUISSE 20240917u
+
+/** Seed of the tie-breaking draws of the labelling and of the projection, which must not depend on `--seed`. */
+#define GRAINE_ETIQUETAGE 0u
+
+/** Largest number of values of a list option of the benchmark (`--bench-rows` ...). */
+#define TAILLE_LISTE_MAX 16
+
+/** Number of Gaussian components of the synthetic benchmark data (`genererMelange`). */
+#define NB_GAUSSIENNES_BENCH 16
+
+/** Memory of the neighbor lists of `--triangle`, in bytes: complete lists up to 11585 neurons, the nearest neighbors that fit above. */
+#define TAILLE_MAX_ELAGAGE ((size_t)1 << 30)
+
+/** One data point out of PAS_CONTROLE_ESQUISSE has its sketched BMU checked against the exact scan. */
+#define PAS_CONTROLE_ESQUISSE 64
+
+/** Period, in milliseconds, at which a process waiting at the shared memory barrier checks that its peers are alive. */
+#define PERIODE_SURVEILLANCE_MS 200
+
+/** Smallest scale of a neuron of the sparse training before its row is rescaled (`apprentissageCreux`). */
+#define ECHELLE_MIN_CREUX 1e-20
+
+
 
 
 /*------------------------STRUCTURES------------------------*/
-/** 
- * @struct neurone
- * @brief Represents a neuron in a Self-Organizing Map (SOM).
+/**
+ * @brief Scalar type of the stored vectors (dataset, codebook, mean vector).
  *
- * This structure holds the feature vector associated with a neuron,
- * its Euclidean distance to an input vector, and its class label.
- * 
- * @Author @Fab.16
+ * `double` by default; building with -DSOM_FLOAT32 stores them as `float`, which halves the
+ * memory traffic of the distance computations. The kernels widen each loaded float to double:
+ * differences, products, distances, norms and accumulators stay in double precision.
+ */
+#ifdef SOM_FLOAT32
+typedef float reel;
+#else
+typedef double reel;
+#endif
+
+/**
+ * @brief Squared Euclidean distance kernel between two vectors of a given dimension.
+ *
+ * Several implementations exist (scalar, SSE2, AVX2, AVX-512); the one matching
+ * the running CPU is picked once by `choisirNoyauDistance`.
+ */
+typedef double (*noyauDistanceCarre)(const reel*, const reel*, int);
+
+/**
+ * @brief Dot product kernel on a 4 x 4 tile: produits[4*i + j] = x[i] . w[j] over `nbDim` components.
+ *
+ * This is the micro-kernel of the mini-batch distance computation; `nbDim` is always a
+ * multiple of the padded row size (one cache line: 8 doubles or 16 floats).
+ */
+typedef void (*noyauProduitTuile)(const reel* const*, const reel* const*, int, double*);
+
+/**
+ * @enum typePhase
+ * @brief Phases of a run timed by the instrumentation (`--stats`).
+ */
+typedef enum typePhase {
+    PHASE_CHARGEMENT,         /**< Reading the dataset */
+    PHASE_NORMALISATION,      /**< Scaling the vectors to a unit norm */
+    PHASE_INITIALISATION,     /**< Mean vector, codebook and shuffled order */
+    PHASE_APPRENTISSAGE,      /**< Training epochs */
+    PHASE_ETIQUETAGE,         /**< Labelling or evaluation pass */
+    PHASE_MODELE,             /**< Writing or mapping the model file */
+    PHASE_PROJECTION,         /**< Projection of new data onto a model */
+    NB_PHASES                 /**< Number of phases */
+} typePhase;
+
+/**
+ * @enum typeVoisinage
+ * @brief Shape of the neighborhood function used by `apprentissage`.
+ */
+typedef enum typeVoisinage {
+    VOISINAGE_BULLE,            /**< Every neuron of the square window gets the full update (original rule) */
+    VOISINAGE_GAUSSIEN,         /**< Update weighted by exp(-d^2 / 2 sigma^2) */
+    VOISINAGE_CHAPEAU_MEXICAIN  /**< Update weighted by (1 - d^2 / sigma^2) exp(-d^2 / 2 sigma^2) */
+} typeVoisinage;
+
+/**
+ * @enum typeTransport
+ * @brief Transport of the accumulator reduction of the multi-process training (`entrainementDistribue`).
+ */
+typedef enum typeTransport {
+    TRANSPORT_MEMOIRE,          /**< Shared memory mapping and a process-shared barrier */
+    TRANSPORT_SOCKET            /**< Unix stream sockets between rank 0 and every other rank */
+} typeTransport;
+
+/**
+ * @struct DictionnaireEtiquettes
+ * @brief Set of distinct labels, each one identified by a small integer.
+ *
+ * The labels are stored once in `noms`; an open addressing hash table maps a
+ * label to its index.
  */
-typedef struct neurone {
-    double* vecteur;              /**< Feature vector of the neuron */
-    double distanceEuclidienne;  /**< Euclidean distance to the current input */
-    char* etiquette;             /**< Label or class associated with the neuron */
-} neurone;
+typedef struct DictionnaireEtiquettes {
+    char** noms;              /**< Distinct labels, by index */
+    int nbNoms;               /**< Number of distinct labels */
+    int capaciteNoms;         /**< Allocated size of `noms` */
+    int* table;               /**< Hash table: index + 1 of a label, 0 for an empty slot */
+    int tailleTable;          /**< Size of the hash table (power of 2) */
+} DictionnaireEtiquettes;
 
 /**
  * @struct dataset
  * @brief Represents a single data point in the dataset.
  *
- * Each data point has a feature vector, its norm, and an associated label.
+ * Each data point has a feature vector, its norm, and the index of its label
+ * in the label dictionary of the dataset.
  */
 typedef struct dataset {
-    double* vecteur;    /**< Feature vector of the data point */
+    reel* vecteur;      /**< Feature vector of the data point */
     double norme;       /**< Norm (magnitude) of the feature vector */
-    char* etiquette;    /**< Label or class of the data point */
+    int classe;         /**< Class of the data point (index in `paramDataset.dico`, -1 if unknown) */
 } dataset;
 
 /**
@@ -38,1078 +178,7702 @@ typedef struct dataset {
  * @brief Holds metadata and buffers for managing a dataset.
  *
  * Includes the full dataset array, vector size information, the mean vector,
- * and a shuffled index array for random sampling.
+ * and a shuffled index array for random sampling. The vector of each data point
+ * is a row of the contiguous `donnees` matrix.
  */
 typedef struct paramDataset {
     dataset* mesDataset;      /**< Array of data points */
+    reel* donnees;            /**< Contiguous, cache-aligned feature matrix (tailleTab x tailleVecPad) */
     int tailleTab;            /**< Number of data points */
     int tailleVec;            /**< Size of each feature vector */
-    double* vecteurMoyen;     /**< Mean vector of the dataset */
+    int tailleVecPad;         /**< Row stride of the feature matrix, padded to a cache line */
+    reel* vecteurMoyen;       /**< Mean vector of the dataset */
     int* tabMelanger;         /**< Index array for shuffling the dataset */
+    int normalise;            /**< 1 if the vectors are already normalized */
+    char* projection;         /**< Mapped binary file holding `donnees` and the labels (NULL if loaded from text) */
+    size_t tailleProjection;  /**< Size of the mapped binary file */
+    DictionnaireEtiquettes dico; /**< Distinct labels of the dataset, indexed by class */
 } paramDataset;
 
+/**
+ * @struct EnteteDataset
+ * @brief Header of a binary dataset file (64 bytes).
+ *
+ * The header is followed, at the given offsets, by the feature block (nbLignes rows of
+ * tailleVecPad scalars, aligned on `ALIGNEMENT_CACHE` bytes), the class of each row
+ * (int32 index in the label table) and the label table (NUL-terminated strings).
+ */
+typedef struct EnteteDataset {
+    char magie[4];            /**< MAGIE_DATASET */
+    uint32_t version;         /**< VERSION_DATASET */
+    uint64_t nbLignes;        /**< Number of data points */
+    uint32_t tailleVec;       /**< Dimension of the vectors */
+    uint32_t tailleVecPad;    /**< Row stride of the feature block */
+    uint32_t tailleReel;      /**< Size in bytes of one scalar (8 = float64, 4 = float32) */
+    uint32_t normalise;       /**< 1 if the rows are already normalized */
+    uint64_t positionDonnees; /**< Offset of the feature block */
+    uint64_t positionClasses; /**< Offset of the class array */
+    uint64_t positionEtiquettes; /**< Offset of the label table */
+    uint32_t nbEtiquettes;    /**< Number of labels in the table */
+    uint32_t reserve;         /**< Unused, 0 */
+} EnteteDataset;
+
+/**
+ * @struct EnteteModele
+ * @brief Header of a trained model file (128 bytes).
+ *
+ * The header is followed, at the given offsets, by the codebook (nbNeurone rows of tailleVecPad
+ * scalars, aligned on `ALIGNEMENT_CACHE` bytes, neuron (i, j) at row i * longueur + j), the squared
+ * norm of each neuron (float64), the purity of each neuron (float64), the mean vector of the
+ * training set (tailleVecPad scalars), the class of each neuron (int32 index in the label table,
+ * -1 if none), the impacts of each neuron (int32) and the label table (NUL-terminated strings).
+ * Every block is aligned for its type, so a mapping of the file is used as is. The queries are
+ * scaled to a unit Euclidean norm before the search, like the training vectors.
+ */
+typedef struct EnteteModele {
+    char magie[4];            /**< MAGIE_MODELE */
+    uint32_t version;         /**< VERSION_MODELE */
+    uint32_t largeur;         /**< Number of rows of the grid */
+    uint32_t longueur;        /**< Number of columns of the grid */
+    uint32_t topologie;       /**< 0: rectangular grid, neurons adjacent in the 8-neighborhood */
+    uint32_t voisinage;       /**< Neighborhood function of the training (`typeVoisinage`) */
+    uint32_t tailleVec;       /**< Dimension of the vectors */
+    uint32_t tailleVecPad;    /**< Row stride of the codebook */
+    uint32_t tailleReel;      /**< Size in bytes of one scalar (8 = float64, 4 = float32) */
+    uint32_t nbEtiquettes;    /**< Number of labels in the table */
+    uint32_t reserve[2];      /**< Unused, 0 */
+    uint64_t positionPoids;   /**< Offset of the codebook */
+    uint64_t positionNormes;  /**< Offset of the squared norms */
+    uint64_t positionPuretes; /**< Offset of the purities */
+    uint64_t positionMoyenne; /**< Offset of the mean vector */
+    uint64_t positionClasses; /**< Offset of the classes */
+    uint64_t positionImpacts; /**< Offset of the impacts */
+    uint64_t positionEtiquettes; /**< Offset of the label table */
+    uint64_t tailleFichier;   /**< Size of the whole file */
+    uint64_t reserve2[2];     /**< Unused, 0 */
+} EnteteModele;
+
+/**
+ * @struct SuiviDerive
+ * @brief How far each neuron moved since a reference copy of the codebook was taken.
+ *
+ * The exact BMU accelerators (`RechercheLocale`, `ElagageTriangulaire`) keep bounds computed on
+ * the reference codebook; `apprentissage` updates the drifts so the bounds can be corrected
+ * for the moves of the neurons without being recomputed.
+ */
+typedef struct SuiviDerive {
+    reel* reference;           /**< Copy of the codebook when the bounds were computed */
+    double* derive;            /**< Distance from each neuron to its position in `reference` */
+    double deriveMax;          /**< Largest drift reached by a neuron since `reference` was taken */
+} SuiviDerive;
+
+/**
+ * @struct RechercheLocale
+ * @brief State of the exact local BMU search of the online rule.
+ *
+ * The BMU of a data point is first searched in the window of radius `rayon` around its
+ * previous BMU p. By the triangle inequality, a neuron n outside that window is at least
+ * at ||w_n - w_p|| - ||x - w_p|| from the data point x, so the local minimum is the global one
+ * when it is strictly below `rayonSur[p]` - drift(p) - largest drift - ||x - w_p||, where
+ * `rayonSur[p]` is a lower bound of the distance from w_p to the nearest neuron outside its
+ * window in the reference codebook of `suivi`, and the drifts bound how far w_p and the outside
+ * neurons moved since then. Otherwise the full scan runs. Only the distances involving a neuron
+ * that moved are recomputed at the start of every epoch.
+ */
+typedef struct RechercheLocale {
+    int rayon;                 /**< Radius of the searched window around the previous BMU */
+    int* derniersBMU;          /**< Last BMU of each data point (-1 before its first search) */
+    double* rayonSur;          /**< Lower bound of the distance from each neuron to the nearest neuron outside its window, in the reference codebook */
+    SuiviDerive suivi;         /**< Drift of the neurons since `rayonSur` was computed */
+    long nbRecherches;         /**< Number of BMU searches */
+    long nbReplis;             /**< Number of local searches the bound could not validate (full scan) */
+    long nbDistances;          /**< Number of distance evaluations, refreshes of `rayonSur` included */
+} RechercheLocale;
+
+/**
+ * @struct ElagageTriangulaire
+ * @brief State of the exact BMU search pruned by the triangle inequality.
+ *
+ * With d a neuron near the data point x, a neuron j is at least at ||w_d - w_j|| - ||x - w_d||
+ * from x, so it cannot beat the best neuron b found so far when ||w_d - w_j|| > ||x - w_d|| +
+ * ||x - w_b||. Each neuron keeps a list of neighbors with their distances, computed on the
+ * reference codebook of `suivi`, and a lower bound of its distance to every neuron missing from
+ * the list; the current distance is at least the stored one minus the drifts of both neurons.
+ * The lists hold every other neuron while they fit in `TAILLE_MAX_ELAGAGE` bytes, and the
+ * `nbVoisinsMax` nearest neighbors above, so the memory stays O(nbNeurone x nbVoisinsMax).
+ * The pairs involving a neuron that moved are recomputed at the start of every epoch.
+ */
+typedef struct ElagageTriangulaire {
+    int nbVoisinsMax;          /**< Capacity of the list of each neuron */
+    int* voisins;              /**< Neighbor lists, `nbVoisinsMax` entries per neuron; a full list is a max-heap on the distance */
+    float* distancesVoisins;   /**< Distances to the listed neighbors in the reference codebook, rounded down */
+    int* nbVoisins;            /**< Number of entries of the list of each neuron */
+    float* rayonReste;         /**< Lower bound of the distance from each neuron to the neurons missing from its list */
+    char* marques;             /**< Marks of the listed neurons during a search (nbNeurone, all zero between searches) */
+    SuiviDerive suivi;         /**< Drift of the neurons since their lists were computed */
+    int* derniersBMU;          /**< Last BMU of each data point, first candidate of its next search (-1 if none) */
+    long nbCandidats;          /**< Number of neurons examined during the epoch */
+    long nbElagues;            /**< Number of neurons pruned without computing their distance during the epoch */
+    int nbLignes;              /**< Number of lists rebuilt at the start of the epoch */
+} ElagageTriangulaire;
+
+/**
+ * @struct Esquisse
+ * @brief State of the two-stage BMU search on random projections.
+ *
+ * The data points and the neurons are projected to `dimension` dimensions by a fixed random
+ * matrix. The `nbCandidats` neurons nearest in the projected space are rescored at full
+ * dimension and the best of them is the BMU. The projection being linear, `apprentissage`
+ * moves the sketch of a neuron along with its weights.
+ */
+typedef struct Esquisse {
+    int dimension;             /**< Dimension of the sketches */
+    int nbCandidats;           /**< Number of candidates rescored at full dimension */
+    float* projection;         /**< Projection matrix (dimension x tailleVec), entries +-1/sqrt(dimension) */
+    reel* esquissesNeurones;   /**< Sketch of each neuron (nbNeurone x dimension), kept up to date by `apprentissage` */
+    reel* esquissesDonnees;    /**< Sketch of each data point (nbDonnees x dimension) */
+    const reel* courante;      /**< Sketch of the data point being learnt, read by `apprentissage` */
+    int* candidats;            /**< Candidates of the current search, as a max-heap on the sketch distance */
+    double* distancesCandidats; /**< Sketch distances of the candidates */
+    long nbControles;          /**< Number of searches checked against the exact scan during the epoch */
+    long nbExacts;             /**< Number of checked searches that found an exact BMU */
+} Esquisse;
+
+/**
+ * @struct Generateur
+ * @brief State of a xoshiro256** pseudo-random generator.
+ *
+ * Seeded from a 64-bit value with splitmix64 (`creerGenerateur`). `sauterGenerateur` moves the
+ * state 2^128 draws ahead, which splits one seed into non-overlapping streams for the threads.
+ * A generator must only be used by one thread at a time.
+ */
+typedef struct Generateur {
+    uint64_t etat[4];         /**< The 256 bits of state (never all zero) */
+} Generateur;
+
+/**
+ * @struct Compteurs
+ * @brief Hot-path counters of the instrumentation.
+ */
+typedef struct Compteurs {
+    long nbRecherches;        /**< Number of BMU searches */
+    long nbDistances;         /**< Number of complete input-to-neuron distance evaluations */
+    long nbAbandons;          /**< Number of distance evaluations stopped early by `rechercheBMUAbandon` */
+    long nbEgalites;          /**< Number of BMU searches with several neurons at the minimum distance */
+    long nbMisesAJour;        /**< Number of neuron weight updates */
+} Compteurs;
+
+/**
+ * @struct Instrumentation
+ * @brief Timers and counters of a run, written as a JSON report by `ecrireRapport` (`--stats`).
+ *
+ * The worker threads count in a private copy (`mesuresThreads`), added to the copy of the
+ * main thread at the end of each parallel step (`fusionnerMesures`).
+ */
+typedef struct Instrumentation {
+    Compteurs compteurs;      /**< Hot-path counters */
+    double debut;             /**< Time stamp of the creation */
+    double phases[NB_PHASES]; /**< Wall time of each phase, in seconds */
+    double* epoques;          /**< Wall time of each training epoch, in seconds */
+    int nbEpoques;            /**< Number of timed epochs */
+    int capaciteEpoques;      /**< Allocated size of `epoques` */
+    long octetsCharges;       /**< Number of bytes of input read */
+    int nbThreads;            /**< Number of threads of the run */
+} Instrumentation;
+
 /**
  * @struct ParamMatrice
- * @brief Configuration and container for the SOM neuron matrix.
+ * @brief Configuration and container for the SOM neuron matrix (the codebook).
+ *
+ * The weights of all the neurons live in a single cache-aligned block of
+ * `nbNeurone` rows, each row padded to `tailleVecPad` values so that every
+ * neuron starts on a cache line. The neuron at grid position (i, j) is row
+ * `i * longueur + j`. Distances and labels are kept in parallel arrays indexed
+ * the same way, so the distance pass and the weight update are linear streams.
  *
- * Stores the matrix dimensions, neuron grid, learning rate,
- * and number of neighbors to update during training.
+ * @Author @Fab.16
  */
 typedef struct ParamMatrice {
     int longueur;         /**< Number of rows in the neuron matrix */
     int largeur;          /**< Number of columns in the neuron matrix */
-    neurone** matrice;    /**< 2D array of neurons */
+    int nbNeurone;        /**< Total number of neurons (largeur * longueur) */
+    int tailleVec;        /**< Dimension of each weight vector */
+    int tailleVecPad;     /**< Row stride of the weight block, padded to a cache line */
+    reel* poids;          /**< Contiguous weight block (nbNeurone x tailleVecPad) */
+    double* distances;    /**< Squared distance of each neuron to the current input */
+    double* normes;       /**< Squared norm of each neuron's weight vector, kept up to date */
+    int* classes;         /**< Class associated with each neuron (-1 if none) */
+    int* impacts;         /**< Number of data points whose BMU is the neuron (labelling pass) */
+    double* purete;       /**< Share of the impacts belonging to the class of the neuron */
+    SuiviDerive* suivi;   /**< Drift of the neurons for an exact BMU accelerator, kept up to date by `apprentissage`, or NULL */
+    Esquisse* esquisse;   /**< Sketches of the two-stage BMU search, kept up to date by `apprentissage`, or NULL */
+    Instrumentation* mesure; /**< Counters of `--stats`, or NULL (nothing is counted) */
+    Generateur* generateur;  /**< Stream of the initialization, the shuffles and the ties of the sequential training, or NULL */
+    int abandon;          /**< 1 to find the BMU with the early-abandoning scan (`rechercheBMUAbandon`) */
+    noyauDistanceCarre noyauDistance; /**< Squared distance kernel selected for this CPU */
+    noyauProduitTuile noyauProduit;   /**< Tile dot product kernel selected for this CPU */
+    typeVoisinage voisinage;  /**< Shape of the neighborhood function */
+    double* tableVoisinage;   /**< Neighborhood weights for each radius up to rayonTable (NULL for the bubble) */
+    int rayonTable;           /**< Largest radius stored in tableVoisinage */
     double alpha;         /**< Learning rate */
     int nbVoisin;         /**< Number of neighboring neurons to update */
 } ParamMatrice;
 
 /**
- * @struct Element
- * @brief Represents a node in a singly linked list of BMUs (Best Matching Units).
+ * @struct Modele
+ * @brief Trained model mapped from a file written by `ecrireModele`.
  *
- * Stores the coordinates (x, y) of a neuron and a pointer to the next element.
+ * The codebook, norms and label arrays of `carte` point into the read-only mapping; only the
+ * `distances` buffer of the BMU search is allocated.
  */
-typedef struct Element {
-    int x;                /**< Row index of the BMU in the neuron matrix */
-    int y;                /**< Column index of the BMU in the neuron matrix */
-    struct Element* suivant; /**< Pointer to the next element in the list */
-} Element;
+typedef struct Modele {
+    char* projection;         /**< Mapped model file (NULL if the load failed) */
+    size_t tailleProjection;  /**< Size of the mapped file */
+    ParamMatrice carte;       /**< The trained map, ready for `trouverBMU` (must not be trained further) */
+    reel* vecteurMoyen;       /**< Mean vector of the training set */
+    DictionnaireEtiquettes dico; /**< Label table, indexed by the classes of `carte` */
+} Modele;
 
 /**
- * @struct Liste
- * @brief Represents a singly linked list of BMUs.
+ * @struct BMU
+ * @brief Result of a Best Matching Unit search for one input vector.
  *
- * Points to the first element (head) of the list.
+ * Holds the winning neuron (a random one among ties) and the runner-up,
+ * which is what the topographic error needs.
  */
-typedef struct Liste {
-    Element* premier;     /**< Head of the linked list */
-} Liste;
+typedef struct BMU {
+    int x;                  /**< Row index of the BMU in the neuron matrix */
+    int y;                  /**< Column index of the BMU in the neuron matrix */
+    int indice;             /**< Index of the BMU in the weight block */
+    double distance;        /**< Squared distance between the input and the BMU */
+    int indiceSecond;       /**< Index of the second best neuron (-1 if there is none) */
+    double distanceSecond;  /**< Squared distance between the input and the second best neuron */
+    int nbEgalites;         /**< Number of neurons sharing the minimum distance */
+} BMU;
 
 /**
- * @struct ParamListeChaine
- * @brief Contains a list of BMUs and its size.
- *
- * Used to store and process the sequence of BMUs found during dataset traversal.
+ * @struct ListeEntiers
+ * @brief List of integers read from a comma-separated option value.
  */
-typedef struct ParamListeChaine {
-    Liste* lesBMU;            /**< Linked list of BMUs */
-    int tailleListeBMU;       /**< Number of elements in the list */
-} ParamListeChaine;
+typedef struct ListeEntiers {
+    int valeurs[TAILLE_LISTE_MAX]; /**< The values, in command line order */
+    int nb;                   /**< Number of values */
+} ListeEntiers;
 
+/**
+ * @struct ListeReels
+ * @brief List of real numbers read from a comma-separated option value.
+ */
+typedef struct ListeReels {
+    double valeurs[TAILLE_LISTE_MAX]; /**< The values, in command line order */
+    int nb;                   /**< Number of values */
+} ListeReels;
 
+/**
+ * @struct ParamExecution
+ * @brief Run configuration read from the command line.
+ *
+ * The default values reproduce the original Iris run.
+ */
+typedef struct ParamExecution {
+    char* fichier;            /**< Dataset file */
+    char* delimiteur;         /**< Field delimiter of the dataset file */
+    double alpha;             /**< Initial learning rate */
+    int temps;                /**< Number of training epochs */
+    typeVoisinage voisinage;  /**< Shape of the neighborhood function */
+    int batch;                /**< 1 for batch training, 0 for the online rule */
+    int tailleLot;            /**< Number of data points whose distances are computed together (1 = one at a time) */
+    int nbThreads;            /**< Number of threads used by the parallel modes */
+    char* fichierBinaire;     /**< Binary dataset to write (--convert), or NULL */
+    int nbNeurone;            /**< Requested number of neurons (0 = 5 * sqrt(number of data points)) */
+    int flux;                 /**< 1 to train from a stream in constant memory */
+    int tailleFenetre;        /**< Number of records per window in streaming mode */
+    int creux;                /**< 1 if the dataset is a sparse libsvm file, trained in CSR form */
+    int rayonLocal;           /**< Radius of the local BMU search of the online rule (0 = full scan) */
+    int abandon;              /**< 1 to find the BMU with the early-abandoning scan */
+    int ordreVariance;        /**< 1 to sum the dimensions by decreasing variance (with `abandon`) */
+    int triangle;             /**< 1 to prune the BMU search of the online rule with the triangle inequality */
+    int dimensionEsquisse;    /**< Dimension of the sketches of the two-stage BMU search of the online rule (0 = off) */
+    int nbCandidats;          /**< Number of candidates of the two-stage search rescored at full dimension */
+    int hogwild;              /**< 1 to run the online rule on `nbThreads` threads sharing the codebook without locks */
+    int verificationHogwild;  /**< 1 to compare the quantization error of `hogwild` with a single-threaded run */
+    int nbProcessus;          /**< Number of processes of the batch training (1 = in-process threads only) */
+    typeTransport transport;  /**< Transport of the accumulator reduction between the processes */
+    char* fichierModele;      /**< Trained model to write after the training (--save-model), or NULL */
+    char* modele;             /**< Trained model to evaluate instead of training (--model), or NULL */
+    char* sortieProjection;   /**< Output of the projection of the data onto `modele` (--project), or NULL */
+    char* fichierBench;       /**< CSV file receiving the benchmark results (--bench), or NULL */
+    char* fichierStats;       /**< JSON file receiving the instrumentation report (--stats), or NULL */
+    uint64_t graine;          /**< Seed of the random draws (--seed, default: the current time) */
+    ListeEntiers benchLignes;     /**< Numbers of synthetic data points of the benchmark */
+    ListeEntiers benchDimensions; /**< Dimensions of the synthetic data points of the benchmark */
+    ListeEntiers benchNeurones;   /**< Map sizes of the benchmark */
+    ListeEntiers benchEpoques;    /**< Numbers of epochs of the benchmark */
+    ListeEntiers benchThreads;    /**< Numbers of threads of the benchmark */
+    char* fichierBalayage;    /**< CSV file receiving the ranked results of the sweep (--sweep), or NULL */
+    ListeReels balayageAlpha;     /**< Initial learning rates of the sweep */
+    ListeEntiers balayageEpoques; /**< Numbers of epochs of the sweep */
+    ListeEntiers balayageNeurones; /**< Numbers of neurons of the sweep (0 = 5 * sqrt(number of data points)) */
+} ParamExecution;
 
+/**
+ * @struct VarianceDimension
+ * @brief Variance of one dimension of the dataset, for sorting the dimensions.
+ */
+typedef struct VarianceDimension {
+    double variance;          /**< Variance of the dimension over the dataset */
+    int indice;               /**< Index of the dimension */
+} VarianceDimension;
 
+/**
+ * @struct TacheChargement
+ * @brief Slice of a mapped text file parsed by one thread of `traitementFichier`.
+ *
+ * A line belongs to the slice that contains its first character.
+ */
+typedef struct TacheChargement {
+    const char* texte;         /**< Whole file contents */
+    size_t tailleTexte;        /**< Size of the file in bytes */
+    size_t debut;              /**< First byte of the slice */
+    size_t fin;                /**< One past the last byte of the slice */
+    char delimiteur;           /**< Field delimiter */
+    long nbLignes;             /**< Number of non-empty lines of the slice (pass 1) */
+    long premiereLigne;        /**< Index of the first data point of the slice (pass 2) */
+    int nbErreurs;             /**< Number of malformed lines met (pass 2) */
+    paramDataset data;         /**< Destination of the parsed data points (pass 2) */
+    DictionnaireEtiquettes dico; /**< Labels met in the slice, by order of appearance (pass 2) */
+} TacheChargement;
 
+/**
+ * @struct LecteurFlux
+ * @brief Reads a text dataset one window of records at a time, in constant memory.
+ *
+ * The records of a window are normalized as they are read and stored in a fixed
+ * buffer; their labels are interned in a dictionary and kept as class indices.
+ */
+typedef struct LecteurFlux {
+    FILE* fichier;            /**< Input file, or stdin */
+    int relisible;            /**< 1 if the input can be rewound for another pass */
+    char* ligne;              /**< Line buffer (grown by getline) */
+    size_t capaciteLigne;     /**< Allocated size of the line buffer */
+    int lignePendante;        /**< 1 if `ligne` holds a record not consumed yet */
+    char delimiteur;          /**< Field delimiter */
+    int tailleVec;            /**< Dimension of the records */
+    int tailleVecPad;         /**< Row stride of the window buffer */
+    int tailleFenetre;        /**< Maximum number of records in a window */
+    reel* fenetre;            /**< Records of the current window (tailleFenetre x tailleVecPad) */
+    int* classes;             /**< Class index of each record of the window */
+    int* ordre;               /**< Shuffled order of the records of the window */
+    Generateur generateur;    /**< Stream of the window shuffles */
+    long nbErreurs;           /**< Number of malformed records met */
+    long nbOctets;            /**< Number of bytes of records read */
+} LecteurFlux;
 
-/*------------------------PROTOTYPES------------------------*/
+/**
+ * @struct DatasetCreux
+ * @brief Sparse dataset in CSR (compressed sparse row) form, read from a libsvm file.
+ *
+ * The nonzeros of data point k are at positions `debutLignes[k]` to `debutLignes[k+1] - 1`
+ * of `colonnes` (0-based dimensions) and `valeurs`. Every row is scaled to a unit norm on
+ * loading, like the dense rows, and its squared norm is kept in `normes`.
+ */
+typedef struct DatasetCreux {
+    long* debutLignes;        /**< Position of the first nonzero of each row (nbLignes + 1 entries) */
+    int* colonnes;            /**< Dimension of each nonzero */
+    reel* valeurs;            /**< Value of each nonzero */
+    double* normes;           /**< Squared norm of each row (1, or 0 for an empty row) */
+    int* classes;             /**< Class index of each row (in `dico`) */
+    int nbLignes;             /**< Number of rows */
+    int tailleVec;            /**< Dimension of the rows (largest index of the file) */
+    long nbNonNuls;           /**< Number of nonzeros */
+    long nbErreurs;           /**< Number of malformed lines skipped */
+    long nbOctets;            /**< Size of the file in bytes */
+    DictionnaireEtiquettes dico; /**< Label table, indexed by `classes` */
+} DatasetCreux;
 
-paramDataset traitementFichier(char*,char*);
-dataset donneeToStructure(char*, char*, int);
-void afficherData(int, int, dataset*);
-void afficherVecteurNeurone(int, int, neurone*);
-dataset * NormaliserVecteur(dataset*, int, int);
-void vecteurMoyen(dataset*, int, int, double*);
-neurone* genereVecteurDouble(int, int, double, double, double*);
-int * indiceMelange(dataset*, int, int);
-ParamMatrice genererMatriceNeurone(ParamMatrice, neurone*, int);
-void afficherMatriceNeurone(ParamMatrice, int);
-double distanceEuclidienne (double*, double*, int);
-void distanceEuclidienneMatrice(double*, neurone**, int, int, int);
-void rapprochement(paramDataset, ParamMatrice, double, int);
-ParamListeChaine rechercheBMU(ParamMatrice);
-Liste * initialisationListe(int, int);
-void ajouterElement(Liste*, int, int);
-void supprimerListe(ParamListeChaine);
-Element * randomElementListeBMU(Liste*, int);
-void apprentissage(Element*, ParamMatrice, double, int, int, double*);
-void putEtiquette(ParamMatrice, paramDataset);
-int indexPetitTab(double[], int);
-void afficheEtiquette(ParamMatrice);
-int equals(char*, char*);
+/**
+ * @struct TacheBatch
+ * @brief Work assigned to one thread during an epoch of batch training.
+ *
+ * Depending on the step, `debut`/`fin` delimit a range of data points
+ * (BMU assignment) or a range of neurons (accumulation and update).
+ */
+typedef struct TacheBatch {
+    paramDataset data;         /**< The dataset (shared, read only) */
+    ParamMatrice dataMatrice;  /**< The codebook, with a private `distances` buffer */
+    int* bmus;                 /**< BMU index of each data point (shared) */
+    int* seconds;              /**< Second best neuron of each data point, or NULL if not needed */
+    double* distancesBMU;      /**< Squared distance of each data point to its BMU, or NULL if not needed */
+    int tailleLot;             /**< Mini-batch size of the BMU assignment */
+    double* sommes;            /**< Sum of the data points won by each neuron (nbNeurone x tailleVecPad) */
+    double* comptes;           /**< Number of data points won by each neuron */
+    int debut;                 /**< First data point or neuron handled by the thread */
+    int fin;                   /**< One past the last data point or neuron handled by the thread */
+    int voisin;                /**< Neighborhood radius of the epoch */
+    uint64_t graine;           /**< Seed of the tie-breaking draws: the data point k draws from `creerGenerateur(graine + k)` */
+} TacheBatch;
 
+/**
+ * @struct TacheHogwild
+ * @brief Shard of the shuffled data points trained by one thread of `entrainementHogwild`.
+ */
+typedef struct TacheHogwild {
+    paramDataset data;         /**< The dataset (shared, read only) */
+    ParamMatrice dataMatrice;  /**< The codebook (shared, updated without locks), with a private `distances` buffer */
+    Generateur generateur;     /**< Private stream of the tie-breaking draws */
+    int debut;                 /**< First position of the shard in `tabMelanger` */
+    int fin;                   /**< One past the last position of the shard */
+    double alpha;              /**< Learning rate of the epoch */
+    int voisin;                /**< Neighborhood radius of the epoch */
+} TacheHogwild;
 
+/**
+ * @struct BarriereProcessus
+ * @brief Barrier shared by the processes of the shared memory reduction, which survives a dead process.
+ *
+ * The mutex is robust and the waits are timed, so a process that dies never leaves the others
+ * blocked: the first one to notice sets `abandon` and every waiting process returns an error.
+ */
+typedef struct BarriereProcessus {
+    pthread_mutex_t verrou;    /**< Robust, process-shared mutex */
+    pthread_cond_t condition;  /**< Process-shared condition on the monotonic clock */
+    int nbArrives;             /**< Number of processes arrived in the current generation */
+    unsigned generation;       /**< Incremented each time all the processes have arrived */
+    int abandon;               /**< 1 once a process has been found dead */
+} BarriereProcessus;
 
+/**
+ * @struct TransportReduction
+ * @brief Sum of a vector of doubles over the processes of `entrainementDistribue` (all-reduce).
+ *
+ * Created by `creerTransport` before the processes are forked, then set up in each process by
+ * `rejoindreTransport`. `reduire` replaces the vector of every process by the sum of the vectors
+ * of all the processes, added in rank order, so every process gets the same bits whatever the
+ * transport. Another transport (TCP between hosts, for instance) only needs its own creation
+ * and reduction functions.
+ */
+typedef struct TransportReduction {
+    typeTransport type;        /**< Kind of transport */
+    int rang;                  /**< Rank of the process (0 = the parent) */
+    int nbProcessus;           /**< Number of processes */
+    size_t taille;             /**< Number of doubles of the reduced vector */
+    int (*reduire)(struct TransportReduction*, double*); /**< Reduction of the transport, 0 on success */
+    char* zone;                /**< Shared mapping: barrier, one slot per rank, then the result (shared memory) */
+    size_t tailleZone;         /**< Size of the shared mapping */
+    BarriereProcessus* barriere; /**< Barrier at the start of `zone` (shared memory) */
+    pid_t parent;              /**< Process id of rank 0 */
+    pid_t* processus;          /**< Process ids of the ranks, 0 once reaped (rank 0 only) */
+    double* emplacements;      /**< Slot of each rank (shared memory) */
+    double* resultat;          /**< Reduced vector (shared memory) */
+    int* descripteurs;         /**< Socket pair of each rank r: end of rank 0 at 2r, end of rank r at 2r+1 (sockets) */
+    double* recu;              /**< Receive buffer of rank 0 (sockets) */
+} TransportReduction;
 
-/*------------------------FONCTIONS------------------------*/
+/**
+ * @struct TacheProjection
+ * @brief Slice of a window of records projected by one thread of `projectionFlux`.
+ *
+ * The thread finds the BMU of its records and formats their output lines, so the main
+ * thread only writes the buffers of the slices in order.
+ */
+typedef struct TacheProjection {
+    TacheBatch affectation;    /**< BMU search of the records `debut` to `fin` of the window */
+    char* const* noms;         /**< Label of each class of the model */
+    char* texte;               /**< Output lines of the slice */
+    size_t tailleTexte;        /**< Length of the output lines */
+    size_t capaciteTexte;      /**< Allocated size of `texte` */
+} TacheProjection;
 
+/**
+ * @struct ConfigurationBalayage
+ * @brief One map configuration of the sweep, and the result of its training.
+ */
+typedef struct ConfigurationBalayage {
+    double alpha;              /**< Initial learning rate */
+    int temps;                 /**< Number of epochs */
+    int nbNeurone;             /**< Requested number of neurons */
+    int nbNeuroneCarte;        /**< Number of neurons of the map actually built */
+    double erreurQuantification; /**< Quantization error of the trained map */
+    double erreurTopographique;  /**< Topographic error of the trained map */
+    int rangQuantification;    /**< Rank of the quantization error among the configurations (1 = best) */
+    int rangTopographique;     /**< Rank of the topographic error among the configurations (1 = best) */
+    double duree;              /**< Wall time of the training and of the labelling, in seconds */
+    int ouvrier;               /**< Worker that trained the configuration */
+} ConfigurationBalayage;
 
 /**
- * @brief Reads a data file and stores its contents in a structured dataset.
- *
- * This function opens a file specified by its name, reads it line by line,
- * splits each line using the given delimiter, and converts the data into
- * a `dataset` structure. It also computes and stores the number of vectors,
- * their size, and allocates space for the mean vector.
- *
- * @param nomFichier The name of the file to read (CSV or similar format).
- * @param delimiteur The delimiter used to split each line (e.g., "," or "\t").
- * @return A fully populated `paramDataset` structure containing:
- *         - an array of dataset entries,
- *         - the size of the dataset,
- *         - the dimension of the vectors,
- *         - a placeholder for the mean vector.
+ * @struct FileTravail
+ * @brief Queue of configurations of one worker of the sweep.
  *
- * @note Each line of the file is expected to contain a vector followed by a label.
- *       The number of delimiter occurrences in the first line defines the vector size.
- * @warning If the file cannot be opened, a warning is printed to the console and
- *          the returned structure may be incomplete or invalid.
+ * The owner takes from the end (`fin`), the other workers steal from the start (`debut`).
  */
-paramDataset traitementFichier(char* nomFichier, char * delimiteur){
+typedef struct FileTravail {
+    pthread_mutex_t verrou;    /**< Protects `debut` and `fin` */
+    int* indices;              /**< Indices of the configurations, by increasing estimated cost */
+    int debut;                 /**< First configuration not taken */
+    int fin;                   /**< One past the last configuration not taken */
+} FileTravail;
 
-    FILE* fichier = NULL;
-    char caractereActuel;
-    char * ligneActuel = (char*)malloc(sizeof(char));
-    int i = 0, nbDelimiteur = 0, nbDonnee = 0;
-    paramDataset paramGlobal;
-    paramGlobal.mesDataset = (dataset*)malloc(sizeof(dataset));
+/**
+ * @struct OuvrierBalayage
+ * @brief Worker thread of the sweep (`ouvrierBalayage`).
+ */
+typedef struct OuvrierBalayage {
+    paramDataset data;         /**< The dataset (shared, read only) */
+    ParamExecution param;      /**< The run configuration */
+    ConfigurationBalayage* configurations; /**< All the configurations (each written by the worker that trains it) */
+    FileTravail* files;        /**< The queues of all the workers */
+    int nbOuvriers;            /**< Number of workers */
+    int numero;                /**< Index of the worker, and of its queue */
+    int nbTaches;              /**< Number of configurations trained by the worker */
+    int nbVols;                /**< Number of configurations stolen from the other queues */
+} OuvrierBalayage;
 
 
-    fichier = fopen(nomFichier, "r");
 
-    if (fichier != NULL){
 
-        while ((caractereActuel = fgetc(fichier)) != EOF){
 
-            //printf("%c",caractereActuel); // affichage de tout le fichier caractère par caractère
 
-            if(caractereActuel!='\n'){  // récuperation d'une ligne
 
-                ligneActuel[i] = caractereActuel;
-                i++;
-                ligneActuel = realloc(ligneActuel, i+1);
+/*------------------------PROTOTYPES------------------------*/
 
-                if(caractereActuel==delimiteur[0] && nbDonnee==0){ // calcule de la taille des vecteurs
-                    nbDelimiteur++;
-                }
-            }
+double chronometre(void);
+Instrumentation creerInstrumentation(int);
+void mesurerPhase(Instrumentation*, typePhase, double);
+void noterEpoque(Instrumentation*, double);
+Instrumentation * mesuresThreads(ParamMatrice, int);
+void fusionnerMesures(ParamMatrice, Instrumentation*, int);
+long tailleFichier(char*);
+long memoireMax(void);
+int ecrireRapport(Instrumentation*, char*, char*);
+void libererInstrumentation(Instrumentation);
+const char * projeterFichier(char*, size_t*);
+void libererProjection(const char*, size_t);
+double lireReel(const char*, const char*, const char**);
+size_t debutLigneSuivante(const char*, size_t, size_t);
+int ligneVide(const char*, size_t, size_t);
+void * compterLignes(void*);
+int analyserLigne(const char*, const char*, char, int, reel*, const char**, size_t*);
+void * analyserLignes(void*);
+paramDataset traitementFichier(char*, char*, int);
+DictionnaireEtiquettes creerDictionnaire(void);
+int internerEtiquette(DictionnaireEtiquettes*, const char*, size_t);
+void libererDictionnaire(DictionnaireEtiquettes);
+int ecrireDatasetBinaire(paramDataset, char*);
+int ecrireModele(ParamMatrice, reel*, DictionnaireEtiquettes, char*);
+Modele chargerModele(char*);
+void libererModele(Modele);
+int blocDansFichier(uint64_t, uint64_t, uint64_t, uint64_t, uint64_t);
+int lireTableEtiquettes(const char*, const char*, uint32_t, DictionnaireEtiquettes*);
+int estDatasetBinaire(char*);
+paramDataset chargerDatasetBinaire(char*);
+void afficherData(int, int, dataset*, DictionnaireEtiquettes);
+void afficherVecteurNeurone(int, int, int, reel*);
+dataset * NormaliserVecteur(dataset*, int, int);
+void vecteurMoyen(dataset*, int, int, reel*);
+void * allocAligne(size_t);
+void libererAligne(void*);
+uint64_t etendreGraine(uint64_t*);
+Generateur creerGenerateur(uint64_t);
+uint64_t tirerGenerateur(Generateur*);
+uint32_t tirerBorne(Generateur*, uint32_t);
+double tirerUniforme(Generateur*);
+void sauterGenerateur(Generateur*);
+int verifierGenerateur(void);
+void melangerIndices(int*, int, Generateur*);
+void genereVecteurDouble(ParamMatrice, double, double, reel*);
+int * indiceMelange(int, Generateur*);
+ParamMatrice genererMatriceNeurone(ParamMatrice, int, int);
+int nombreProcesseurs(void);
+void lancerThreads(int, void*(*)(void*), void*, size_t);
+reel * vecteurNeurone(ParamMatrice, int, int);
+void afficherMatriceNeurone(ParamMatrice, int);
+double distanceEuclidienne (reel*, reel*, int);
+double distanceCarreScalaire(const reel*, const reel*, int);
+#ifdef SOM_X86
+double distanceCarreSSE2(const reel*, const reel*, int);
+double distanceCarreAVX2(const reel*, const reel*, int);
+double distanceCarreAVX512(const reel*, const reel*, int);
+#endif
+noyauDistanceCarre choisirNoyauDistance(void);
+void produitTuileScalaire(const reel* const*, const reel* const*, int, double*);
+#ifdef SOM_X86
+void produitTuileAVX2(const reel* const*, const reel* const*, int, double*);
+void produitTuileAVX512(const reel* const*, const reel* const*, int, double*);
+#endif
+noyauProduitTuile choisirNoyauProduit(void);
+void distanceEuclidienneMatrice(reel*, ParamMatrice);
+void rafraichirNormes(ParamMatrice, int, int);
+void preparerLot(paramDataset, int*, int, int, reel*, double*);
+void distancesLot(const reel*, const double*, int, ParamMatrice, double*);
+void bornesFenetre(int, int, int, int*, int*);
+int ouvrirFlux(LecteurFlux*, char*, char*, int, uint64_t);
+int rembobinerFlux(LecteurFlux*);
+int lireFenetre(LecteurFlux*, DictionnaireEtiquettes*);
+void fermerFlux(LecteurFlux*);
+int entrainementFlux(ParamExecution);
+void * projeterTranche(void*);
+int projectionFlux(ParamExecution);
+DatasetCreux chargerLibsvm(char*);
+void libererDatasetCreux(DatasetCreux);
+BMU rechercheBMUCreux(ParamMatrice, const double*, const DatasetCreux*, int, double*, Generateur*);
+void apprentissageCreux(BMU, ParamMatrice, double*, double, int, const DatasetCreux*, int, const double*);
+void materialiserCreux(ParamMatrice, double*);
+int entrainementCreux(ParamExecution);
+void planningApprentissage(int, int, double, double*, int*);
+RechercheLocale creerRechercheLocale(int, int, int, int);
+void rafraichirRechercheLocale(RechercheLocale*, ParamMatrice);
+BMU rechercheBMULocale(RechercheLocale*, ParamMatrice, int, reel*);
+void libererRechercheLocale(RechercheLocale);
+ElagageTriangulaire creerElagage(int, int, int);
+void descendreVoisin(int*, float*, int, int);
+void proposerVoisin(ElagageTriangulaire*, int, int, float);
+void rafraichirElagage(ElagageTriangulaire*, ParamMatrice);
+BMU rechercheBMUElagage(ElagageTriangulaire*, ParamMatrice, int, reel*);
+void libererElagage(ElagageTriangulaire);
+void projeterEsquisse(const Esquisse*, const reel*, int, reel*);
+Esquisse creerEsquisse(paramDataset, int, int, int);
+void rafraichirEsquisse(Esquisse*, ParamMatrice);
+BMU rechercheBMUEsquisse(Esquisse*, ParamMatrice, int, reel*);
+void libererEsquisse(Esquisse);
+void rapprochement(paramDataset, ParamMatrice, double, int, int, int, int, int, int);
+void * hogwildTranche(void*);
+void entrainementHogwild(paramDataset, ParamMatrice, double, int, int);
+double referenceSequentielle(paramDataset, ParamMatrice, ParamExecution, double*, double*);
+void * batchAffectation(void*);
+void * batchAccumulation(void*);
+void * batchMiseAJour(void*);
+void entrainementBatch(paramDataset, ParamMatrice, int, int, int);
+int ecrireTout(int, const void*, size_t);
+int lireTout(int, void*, size_t);
+int pairDisparu(TransportReduction*);
+int attendreBarriere(TransportReduction*);
+int reductionMemoire(TransportReduction*, double*);
+int reductionSocket(TransportReduction*, double*);
+int creerTransport(TransportReduction*, typeTransport, int, size_t, pid_t*);
+void rejoindreTransport(TransportReduction*, int);
+void libererTransport(TransportReduction*);
+int entrainementDistribue(paramDataset, ParamMatrice, int, int, typeTransport, int);
+void comparerBMU(BMU*, int, double, Generateur*);
+BMU rechercheBMU(ParamMatrice, Generateur*);
+BMU rechercheBMUAbandon(ParamMatrice, const reel*, Generateur*);
+BMU trouverBMU(ParamMatrice, reel*, Generateur*);
+int comparerVariances(const void*, const void*);
+int * ordreDimensions(paramDataset);
+void permuterDimensions(reel*, int, int, int, const int*, int);
+double coefficientVoisinage(typeVoisinage, int, int, int);
+ParamMatrice preparerTableVoisinage(ParamMatrice, typeVoisinage, int);
+void apprentissage(BMU, ParamMatrice, double, int, int, reel*);
+void etiquetterHistogramme(ParamMatrice, const int*, int);
+void affectationCarte(paramDataset, ParamMatrice, int, int, int*, double*, double*);
+void etiquetageCarte(paramDataset, ParamMatrice, int, int, double*, double*);
+void evaluerModele(paramDataset, Modele, int, int);
+int genererMelange(char*, int, int, int, uint64_t);
+int benchmark(ParamExecution);
+int prendreTravail(FileTravail*, int, int, int*);
+void executerConfiguration(paramDataset, ParamExecution, ConfigurationBalayage*);
+void * ouvrierBalayage(void*);
+int comparerQuantification(const void*, const void*);
+int comparerTopographique(const void*, const void*);
+int comparerRangs(const void*, const void*);
+int balayage(paramDataset, ParamExecution);
+ListeEntiers lireListe(char*);
+ListeReels lireListeReels(char*);
+void afficheEtiquette(ParamMatrice, DictionnaireEtiquettes);
+void libererMatrice(ParamMatrice);
+void freeAll(paramDataset, ParamMatrice);
+ParamExecution lireArguments(int, char**);
+void afficherUsage(char*);
 
-            else{   // traitement des donnees d'une ligne
-                ligneActuel[i] = '\0';
-                paramGlobal.mesDataset[nbDonnee] = donneeToStructure(ligneActuel, delimiteur, nbDelimiteur);
-                nbDonnee++;
-                paramGlobal.mesDataset = realloc(paramGlobal.mesDataset, (nbDonnee+1) * sizeof(neurone));
-                i = 0;
-            }
-        }
-            fclose(fichier);
-    }
 
-    else{
-        printf("impossible d'ouvrir le fichier");
-    }
 
-    // remplissage des paramètres globale lié au dataset
-    paramGlobal.tailleTab = nbDonnee;
-    paramGlobal.tailleVec = nbDelimiteur;
-    paramGlobal.vecteurMoyen = malloc(nbDelimiteur * sizeof(double));
 
-    return paramGlobal;
-}
+/*------------------------FONCTIONS------------------------*/
 
 
 /**
- * @brief Converts a delimited string into a dataset structure.
- *
- * This function parses a string containing numeric values followed by a label,
- * splits it using the provided delimiter, and stores the values in a `dataset`
- * structure. The numeric values are stored in a vector, and the final token
- * is treated as the label.
+ * @brief Returns a monotonic time stamp in seconds, for timing the phases of a run.
  *
- * @param donnee The input string representing one line of data.
- * @param delimiteur The delimiter used to split the string (e.g., "," or "\t").
- * @param tailleVecteur The expected number of numeric values (dimension of the vector).
- * @return A `dataset` structure containing the parsed vector and its associated label.
- *
- * @note The function assumes that the number of numeric tokens is exactly `tailleVecteur`,
- *       and the label is the last element in the string.
- * @warning Memory is dynamically allocated for both the vector and the label.
- *          The caller is responsible for freeing this memory.
+ * @return The current time in seconds.
  */
-dataset donneeToStructure(char * donnee, char* delimiteur, int tailleVecteur){
-    dataset data;
-    int i = 0;
-    int j = 0;
-    char * token = NULL;
-    data.vecteur = (double*)malloc(tailleVecteur * sizeof(double));
-    data.etiquette = (char*)malloc(sizeof(char));
+double chronometre(void){
+    struct timespec instant;
 
+    clock_gettime(CLOCK_MONOTONIC, &instant);
 
+    return instant.tv_sec + instant.tv_nsec * 1e-9;
+}
 
-    token = strtok(donnee, delimiteur);
 
-    while( token != NULL){
-        if(i<tailleVecteur){
-            data.vecteur[i] = strtod(token,NULL);
-            //printf("%f\n",vecteur[i]);
-        }
+/**
+ * @brief Creates the timers and counters of an instrumented run.
+ *
+ * @param nbThreads The number of threads of the run.
+ * @return The instrumentation, to be released with `libererInstrumentation`.
+ */
+Instrumentation creerInstrumentation(int nbThreads){
+    Instrumentation mesure;
 
-        else{
-            while(token[j]!='\0'){
-                data.etiquette[j] = token[j];
-                j++;
-                data.etiquette = realloc(data.etiquette, (j+1)* sizeof(char));
-            }
-            data.etiquette[j] = '\0';
-        }
-        i++;
+    memset(&mesure, 0, sizeof(mesure));
+    mesure.debut = chronometre();
+    mesure.nbThreads = nbThreads;
 
-        token = strtok(NULL,delimiteur);
-    }
-    i = 0;
+    return mesure;
+}
 
-    return data;
 
+/**
+ * @brief Adds the time elapsed since `debut` to a phase.
+ *
+ * @param mesure The instrumentation, or NULL (nothing is done).
+ * @param phase The phase.
+ * @param debut The time stamp of the start of the phase (`chronometre`).
+ */
+void mesurerPhase(Instrumentation * mesure, typePhase phase, double debut){
+    if(mesure != NULL){
+        mesure->phases[phase] += chronometre() - debut;
+    }
 }
 
 
 /**
- * @brief Displays the contents of a dataset array in a formatted manner.
+ * @brief Records the wall time of a training epoch.
  *
- * This function prints each dataset entry line by line, displaying the vector values
- * separated by commas, followed by the corresponding label.
+ * @param mesure The instrumentation.
+ * @param duree The wall time of the epoch, in seconds.
+ */
+void noterEpoque(Instrumentation * mesure, double duree){
+    if(mesure->nbEpoques == mesure->capaciteEpoques){
+        mesure->capaciteEpoques = (mesure->capaciteEpoques > 0) ? 2 * mesure->capaciteEpoques : 64;
+        mesure->epoques = realloc(mesure->epoques, mesure->capaciteEpoques * sizeof(double));
+    }
+
+    mesure->epoques[mesure->nbEpoques++] = duree;
+}
+
+
+/**
+ * @brief Allocates the private counters of the worker threads of a parallel step.
  *
- * @param nbVecteur The number of data entries in the dataset.
- * @param tailleVecteur The size of each feature vector.
- * @param mesData A pointer to the array of dataset structures to display.
+ * @param dataMatrice The neuron matrix (its `mesure` tells whether the run is instrumented).
+ * @param nbThreads The number of threads.
+ * @return One zeroed instrumentation per thread, or NULL if the run is not instrumented.
+ */
+Instrumentation * mesuresThreads(ParamMatrice dataMatrice, int nbThreads){
+    return (dataMatrice.mesure != NULL) ? calloc(nbThreads, sizeof(Instrumentation)) : NULL;
+}
+
+
+/**
+ * @brief Adds the counters of the worker threads to those of the run and releases them.
  *
- * @note The output format is: `value1,value2,...,valueN,label`
+ * @param dataMatrice The neuron matrix holding the instrumentation of the run.
+ * @param mesures The counters returned by `mesuresThreads` (NULL does nothing).
+ * @param nbThreads The number of threads.
  */
-void afficherData(int nbVecteur, int tailleVecteur, dataset *mesData){
-    int i,j;
+void fusionnerMesures(ParamMatrice dataMatrice, Instrumentation * mesures, int nbThreads){
+    int t;
 
-    for(i=0;i<nbVecteur;i++){
-        for(j=0;j<tailleVecteur;j++){
-            printf("%f",mesData[i].vecteur[j]);
+    if(mesures == NULL){
+        return;
+    }
 
-            if(j<tailleVecteur-1){
-                printf(",");
-            }
-        }
-        printf(",%s", mesData[i].etiquette);
-        printf("\n");
+    for(t=0; t<nbThreads; t++){
+        dataMatrice.mesure->compteurs.nbRecherches += mesures[t].compteurs.nbRecherches;
+        dataMatrice.mesure->compteurs.nbDistances += mesures[t].compteurs.nbDistances;
+        dataMatrice.mesure->compteurs.nbAbandons += mesures[t].compteurs.nbAbandons;
+        dataMatrice.mesure->compteurs.nbEgalites += mesures[t].compteurs.nbEgalites;
+        dataMatrice.mesure->compteurs.nbMisesAJour += mesures[t].compteurs.nbMisesAJour;
     }
+
+    free(mesures);
 }
 
 
 /**
- * @brief Displays the weight vectors of an array of neurons.
- *
- * This function iterates through an array of neurons and prints each neuron's
- * vector components separated by commas.
- *
- * @param nbVecteur The number of neurons to display.
- * @param tailleVecteur The size of each neuron's weight vector.
- * @param mesNeurone A pointer to the array of neurons.
+ * @brief Returns the size of a file.
  *
- * @note Only the vector components are printed; labels and distances are not displayed.
- * @warning The output includes an extra comma before the newline due to redundant printf calls.
+ * @param nomFichier The name of the file.
+ * @return The size in bytes, or 0 if the file cannot be opened.
  */
-void afficherVecteurNeurone(int nbVecteur, int tailleVecteur, neurone *mesNeurone){
-    int i,j;
+long tailleFichier(char * nomFichier){
+    FILE * fichier = fopen(nomFichier, "rb");
+    long taille = 0;
+
+    if(fichier != NULL){
+        fseek(fichier, 0, SEEK_END);
+        taille = ftell(fichier);
+        fclose(fichier);
+    }
 
-    for(i=0;i<nbVecteur;i++){
-        for(j=0;j<tailleVecteur;j++){
-            printf("%f,",mesNeurone[i].vecteur[j]);
+    return taille;
+}
 
-            if(j<tailleVecteur-1){
-                printf(",");
-            }
-        }
-        printf("\n");
+
+/**
+ * @brief Returns the peak resident memory of the process.
+ *
+ * @return The peak resident set size in kilobytes, or -1 where `getrusage` is not available.
+ */
+long memoireMax(void){
+#ifndef _WIN32
+    struct rusage usage;
+
+    if(getrusage(RUSAGE_SELF, &usage) == 0){
+#ifdef __APPLE__
+        return usage.ru_maxrss / 1024; // octets sous macOS
+#else
+        return usage.ru_maxrss;
+#endif
     }
+#endif
+    return -1;
 }
 
 
 /**
- * @brief Normalizes the feature vectors of a dataset.
- *
- * This function computes the Euclidean norm of each vector in the dataset
- * and normalizes each component by dividing it by the corresponding norm.
- * The normalization is done in-place.
+ * @brief Writes the instrumentation report of a run as a JSON object.
  *
- * @param mesStructure A pointer to the dataset array to normalize.
- * @param tailleVecteur The size (dimension) of each feature vector.
- * @param nbVecteur The number of vectors in the dataset.
- * @return A pointer to the same dataset array, now with normalized vectors.
+ * The report holds the mode and number of threads of the run, the total wall time, the wall
+ * time of each phase and of each training epoch, the hot-path counters, the number of bytes of
+ * input read and the peak resident memory.
  *
- * @note This function modifies the input dataset directly.
- * @warning Memory for `norme` is allocated with `calloc`, but never freed — this may cause a memory leak.
+ * @param mesure The instrumentation of the run.
+ * @param nomFichier The name of the JSON file to create.
+ * @param mode The name of the run mode ("online", "batch", "flux" ...).
+ * @return 0 on success, -1 if the file could not be written.
  */
-dataset * NormaliserVecteur(dataset * mesStructure, int tailleVecteur, int nbVecteur){
-    int i,j;
-    double * norme = (double*)calloc(nbVecteur,nbVecteur * sizeof(double));
-
-    for(i=0; i<nbVecteur; i++){
-        for(j=0; j<tailleVecteur; j++){
-            norme[i] += pow(mesStructure[i].vecteur[j],2);
-        }
+int ecrireRapport(Instrumentation * mesure, char * nomFichier, char * mode){
+    const char * nomsPhases[NB_PHASES] = {"chargement", "normalisation", "initialisation", "apprentissage",
+                                          "etiquetage", "modele", "projection"};
+    FILE * fichier = fopen(nomFichier, "w");
+    int k, erreur = 0;
+
+    if(fichier == NULL){
+        return -1;
+    }
 
-        norme[i] = sqrt(norme[i]);
+    fprintf(fichier, "{\n  \"version\": 1,\n  \"mode\": \"%s\",\n  \"threads\": %d,\n  \"duree_totale_s\": %.6f,\n  \"phases_s\": {",
+            mode, mesure->nbThreads, chronometre() - mesure->debut);
 
+    for(k=0; k<NB_PHASES; k++){
+        fprintf(fichier, "%s\n    \"%s\": %.6f", (k > 0) ? "," : "", nomsPhases[k], mesure->phases[k]);
+    }
 
-        for(j=0; j<tailleVecteur; j++){
-            mesStructure[i].vecteur[j] = (mesStructure[i].vecteur[j]/norme[i]);
-        }
+    fprintf(fichier, "\n  },\n  \"epoques_s\": [");
 
+    for(k=0; k<mesure->nbEpoques; k++){
+        fprintf(fichier, "%s%.6f", (k > 0) ? ", " : "", mesure->epoques[k]);
     }
 
-    return mesStructure;
+    fprintf(fichier, "],\n  \"compteurs\": {\n    \"recherches_bmu\": %ld,\n    \"evaluations_distance\": %ld,\n"
+                     "    \"evaluations_abandonnees\": %ld,\n    \"recherches_avec_egalite\": %ld,\n    \"neurones_mis_a_jour\": %ld\n  },\n",
+            mesure->compteurs.nbRecherches, mesure->compteurs.nbDistances, mesure->compteurs.nbAbandons,
+            mesure->compteurs.nbEgalites, mesure->compteurs.nbMisesAJour);
+    fprintf(fichier, "  \"octets_charges\": %ld,\n  \"memoire_max_ko\": %ld\n}\n", mesure->octetsCharges, memoireMax());
 
+    erreur |= fclose(fichier) != 0;
+
+    return erreur ? -1 : 0;
 }
 
 
 /**
- * @brief Computes the mean vector from a dataset.
+ * @brief Releases the instrumentation of a run.
  *
- * This function calculates the component-wise average of all vectors in the dataset
- * and stores the result in the provided `vecteurMoyen` array.
+ * @param mesure The instrumentation.
+ */
+void libererInstrumentation(Instrumentation mesure){
+    free(mesure.epoques);
+}
+
+
+/**
+ * @brief Maps a whole file in memory, read only.
  *
- * @param mesStructure A pointer to the dataset array.
- * @param tailleVecteur The size (dimension) of each feature vector.
- * @param nbVecteur The number of vectors in the dataset.
- * @param vecteurMoyen A pointer to a pre-allocated array where the resulting mean vector will be stored.
+ * On systems without `mmap` the file is read into a heap buffer instead.
  *
- * @note The mean is computed across all dataset entries for each vector component.
- * @warning The array `vecteurMoyen` must be allocated before calling this function.
+ * @param nomFichier The name of the file.
+ * @param taille Output: the size of the file in bytes.
+ * @return A pointer to the contents of the file, or NULL if it cannot be opened.
+ *         An empty file gives a non-NULL pointer and a size of 0.
  */
-void vecteurMoyen(dataset * mesStructure, int tailleVecteur, int nbVecteur, double * vecteurMoyen){
-    int i,j;
-    double somme = 0.0;
-
-    for(i=0;i<tailleVecteur;i++){
-        for(j=0;j<nbVecteur;j++){
-            somme += mesStructure[j].vecteur[i];
-        }
-        vecteurMoyen[i] = somme/nbVecteur;
-        somme = 0.0;
-        //printf("%f\n", vecteurMoyen[i]);
-    }
-}
-
+const char * projeterFichier(char * nomFichier, size_t * taille){
+#ifndef _WIN32
+    int descripteur = open(nomFichier, O_RDONLY);
+    struct stat infos;
+    void * contenu;
 
-/**
- * @brief Generates an array of neurons with random vectors based on a mean vector.
- *
- * This function creates `nbVecteur` neurons, each containing a vector of random double values.
- * The random values are uniformly distributed between `vecteurMoyen[i] - min` and `vecteurMoyen[i] + max`
- * for each component `i`. The number of vectors is adjusted to be a multiple of 10.
- *
- * @param nbVecteur The number of neurons (will be rounded down to nearest multiple of 10).
- * @param tailleVecteurs The size (dimension) of each neuron's vector.
- * @param min The minimum offset from the mean for random generation.
- * @param max The maximum offset from the mean for random generation.
- * @param vecteurMoyen The reference mean vector used to center the random values.
- * @return A pointer to the array of generated neurons.
- *
- * @note Memory is dynamically allocated for each neuron's vector and the resulting array.
- *       Caller is responsible for freeing the returned `neurone*` and its internal vectors.
- * @warning The use of `srand(time(NULL))` on repeated calls in quick succession may produce similar outputs.
- */
-neurone* genereVecteurDouble(int nbVecteur, int tailleVecteurs, double min, double max, double* vecteurMoyen){
+    *taille = 0;
 
-    int i,j;
-    double * borneSupp = (double*)malloc(sizeof(double) * tailleVecteurs);
-    double * borneInf = (double*)malloc(sizeof(double) * tailleVecteurs);
-    neurone* mesNeurones = (neurone*)malloc(sizeof(neurone)*nbVecteur);
+    if(descripteur < 0){
+        return NULL;
+    }
 
-    srand(time(NULL));
+    if(fstat(descripteur, &infos) != 0){
+        close(descripteur);
+        return NULL;
+    }
 
-    nbVecteur = nbVecteur - (nbVecteur%10);
+    *taille = (size_t)infos.st_size;
 
+    if(*taille == 0){
+        close(descripteur);
+        return "";
+    }
 
-    for(i=0; i<tailleVecteurs; i++){
-        borneInf[i] = vecteurMoyen[i] - min;
-        borneSupp[i] = vecteurMoyen[i] + max;
+    contenu = mmap(NULL, *taille, PROT_READ, MAP_PRIVATE, descripteur, 0);
+    close(descripteur);
 
+    if(contenu == MAP_FAILED){
+        return NULL;
     }
 
-    for(i=0;i<nbVecteur;i++){
-        neurone monNeuronne;
-        monNeuronne.vecteur = (double*)malloc(sizeof(double)*tailleVecteurs);
-
+    madvise(contenu, *taille, MADV_SEQUENTIAL);
 
-        for(j=0;j<tailleVecteurs;j++){
-            monNeuronne.vecteur[j]= (rand()/ (RAND_MAX  / (borneSupp[j] - borneInf[j])) + borneInf[j]);
+    return contenu;
+#else
+    FILE * fichier = fopen(nomFichier, "rb");
+    char * contenu;
 
-            //printf("%f;",monNeuronne.vecteur[j]);
-        }
-        //printf("\n");
-        mesNeurones[i] = monNeuronne;
+    *taille = 0;
 
+    if(fichier == NULL){
+        return NULL;
     }
 
-    free(borneInf);
-    free(borneSupp);
+    fseek(fichier, 0, SEEK_END);
+    *taille = (size_t)ftell(fichier);
+    fseek(fichier, 0, SEEK_SET);
+    contenu = malloc(*taille + 1);
+    *taille = fread(contenu, 1, *taille, fichier);
+    fclose(fichier);
 
-    return mesNeurones;
+    return contenu;
+#endif
 }
 
 
 /**
- * @brief Generates a shuffled array of indices for the dataset.
+ * @brief Releases a file mapped by `projeterFichier`.
  *
- * This function initializes an array of indices from 0 to `nbVecteur - 1`
- * and randomly shuffles them using a basic Fisher–Yates algorithm.
+ * @param contenu The contents returned by `projeterFichier`.
+ * @param taille The size of the file in bytes.
+ */
+void libererProjection(const char * contenu, size_t taille){
+#ifndef _WIN32
+    if(taille > 0){
+        munmap((void*)contenu, taille);
+    }
+#else
+    (void)taille;
+    free((void*)contenu);
+#endif
+}
+
+
+/**
+ * @brief Parses a decimal number from a character range that is not NUL-terminated.
  *
- * @param mesData Pointer to the dataset array (not used in the current implementation).
- * @param nbVecteur The number of data points (size of the dataset).
- * @param tailleVecteur The size (dimension) of each feature vector (unused).
- * @return A pointer to an array of shuffled indices.
+ * The digits are read into a 64-bit integer and scaled by an exact power of ten, which
+ * gives the correctly rounded value when the mantissa fits in 53 bits and the exponent is
+ * at most 22 (the common case for CSV data). Other numbers, and special values such as
+ * `nan` or `inf`, are handed to `strtod` on a NUL-terminated copy of the token, on the stack
+ * when it is short and on the heap otherwise.
  *
- * @note The returned array must be freed by the caller.
- * @warning The `mesData` and `tailleVecteur` parameters are not used and could be removed.
- * @warning The random number generation line is incorrect and may result in out-of-bounds access.
+ * @param debut The first character of the range.
+ * @param fin One past the last character of the range.
+ * @param suite Output: the first character after the number (`debut` if nothing was read).
+ * @return The parsed value, or 0 if no number could be read.
  */
-int * indiceMelange(dataset * mesData, int nbVecteur, int tailleVecteur){
+double lireReel(const char * debut, const char * fin, const char ** suite){
+    static const double puissances[23] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                          1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    const char * p = debut;
+    uint64_t mantisse = 0;
+    int exposant = 0, exposantLu = 0, signeExposant = 1, negatif = 0, nbChiffres = 0;
+    char copie[64];
+    char * tampon;
+    char * finCopie;
+    size_t longueur;
+    double valeur;
+
+    while(p < fin && (*p == ' ' || *p == '\t')){
+        p++;
+    }
 
-    int * indexAleatoire = malloc(sizeof(int)*nbVecteur);
-    int i,j,tmp,random;
+    if(p < fin && (*p == '-' || *p == '+')){
+        negatif = (*p == '-');
+        p++;
+    }
 
+    for(; p < fin && *p >= '0' && *p <= '9'; p++, nbChiffres++){
+        if(mantisse < 1000000000000000000ULL){
+            mantisse = mantisse * 10 + (uint64_t)(*p - '0');
+        }
+        else{
+            exposant++;
+        }
+    }
 
-    for(i=0; i<nbVecteur; i++){
-        indexAleatoire[i]=i;
+    if(p < fin && *p == '.'){
+        for(p++; p < fin && *p >= '0' && *p <= '9'; p++, nbChiffres++){
+            if(mantisse < 1000000000000000000ULL){
+                mantisse = mantisse * 10 + (uint64_t)(*p - '0');
+                exposant--;
+            }
+        }
+    }
+
+    if(nbChiffres > 0 && p < fin && (*p == 'e' || *p == 'E')){
+        const char * debutExposant = p++;
+
+        if(p < fin && (*p == '-' || *p == '+')){
+            signeExposant = (*p == '-') ? -1 : 1;
+            p++;
+        }
+
+        if(p < fin && *p >= '0' && *p <= '9'){
+            for(; p < fin && *p >= '0' && *p <= '9'; p++){
+                if(exposantLu < 100000){
+                    exposantLu = exposantLu * 10 + (*p - '0');
+                }
+            }
+            exposant += signeExposant * exposantLu;
+        }
+        else{
+            p = debutExposant;
+        }
+    }
 
+    if(nbChiffres > 0 && mantisse <= (1ULL << 53) && exposant >= -22 && exposant <= 22){
+        valeur = (exposant < 0) ? (double)mantisse / puissances[-exposant] : (double)mantisse * puissances[exposant];
+        *suite = p;
+        return negatif ? -valeur : valeur;
     }
 
+    // cas rare : strtod sur une copie terminee par '\0' des seuls caracteres qu'il peut lire
+    for(p = debut; p < fin && (*p == ' ' || *p == '\t'); p++){
+    }
 
-    for(i=0; i<nbVecteur; i++){
-        random = (rand()/ (RAND_MAX  / nbVecteur));
-        tmp = indexAleatoire[i];
-        indexAleatoire[i]=indexAleatoire[random];
-        indexAleatoire[random] = tmp;
+    while(p < fin && ((*p >= '0' && *p <= '9') || (*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z')
+                      || (*p != '\0' && strchr("+-._()", *p) != NULL))){
+        p++;
     }
 
-    for(i=0; i<nbVecteur; i++){
-            for(j=0; j<tailleVecteur; j++){
+    longueur = (size_t)(p - debut);
+    tampon = (longueur < sizeof(copie)) ? copie : malloc(longueur + 1);
 
-                if(j<tailleVecteur){
+    if(tampon == NULL){
+        *suite = debut;
+        return 0.0;
+    }
 
-                }
-            }
+    memcpy(tampon, debut, longueur);
+    tampon[longueur] = '\0';
+    valeur = strtod(tampon, &finCopie);
+    *suite = debut + (finCopie - tampon);
+
+    if(tampon != copie){
+        free(tampon);
     }
 
-    return indexAleatoire;
+    return valeur;
 }
 
 
 /**
- * @brief Creates and fills a matrix of neurons from a linear list of neurons.
- *
- * This function initializes a 2D matrix of neurons from a given 1D array.
- * The matrix dimensions are computed so that the width is set to one-tenth of the total number
- * of neurons (`nbNeurone / 10`), and the height is derived accordingly to fit all neurons.
+ * @brief Finds the first line that starts at or after a given position.
  *
- * @param dataMatrice A `ParamMatrice` structure, partially filled and passed by value.
- * @param mesNeurone A linear array of `neurone` elements to fill the matrix.
- * @param nbNeurone The total number of neurons to place in the matrix.
- * @return The updated `ParamMatrice` structure containing the filled matrix.
- *
- * @note The matrix is filled row by row (left to right, top to bottom).
- *       Memory is dynamically allocated for each row of the matrix.
- *       Caller is responsible for freeing the matrix afterward.
- * @warning Assumes `nbNeurone` is divisible by 10. No check is performed to validate this.
+ * @param texte The file contents.
+ * @param taille The size of the file contents.
+ * @param position The position to start from.
+ * @return The position of the first character of the next line (`taille` if there is none).
  */
-ParamMatrice genererMatriceNeurone(ParamMatrice dataMatrice, neurone * mesNeurone, int nbNeurone){
-    int i,j,k = 0;
+size_t debutLigneSuivante(const char * texte, size_t taille, size_t position){
+    const char * saut;
 
-    dataMatrice.largeur = nbNeurone/10;
-    dataMatrice.longueur = nbNeurone/dataMatrice.largeur;
+    if(position == 0 || position >= taille || texte[position-1] == '\n'){
+        return position;
+    }
 
-    neurone** matriceNeurone = malloc(sizeof(neurone*) * dataMatrice.largeur);
+    saut = memchr(texte + position, '\n', taille - position);
 
+    return (saut != NULL) ? (size_t)(saut - texte) + 1 : taille;
+}
 
-    for(i=0; i<dataMatrice.largeur; i++){
-        matriceNeurone[i] = malloc(sizeof(neurone) * dataMatrice.longueur);
-    }
 
-    for(i=0; i<dataMatrice.largeur; i++){
-        for(j=0; j<dataMatrice.longueur; j++){
-            matriceNeurone[i][j] = mesNeurone[k];
-            k++;
+/**
+ * @brief Tells whether a line only contains blanks.
+ *
+ * @param texte The file contents.
+ * @param debut The first character of the line.
+ * @param fin The end of the line (position of the '\n' or end of file).
+ * @return 1 if the line is empty or blank, 0 otherwise.
+ */
+int ligneVide(const char * texte, size_t debut, size_t fin){
+    for(; debut < fin; debut++){
+        if(texte[debut] != ' ' && texte[debut] != '\t' && texte[debut] != '\r'){
+            return 0;
         }
     }
 
-    dataMatrice.matrice = matriceNeurone;
-
-    return dataMatrice;
+    return 1;
 }
 
 
 /**
- * @brief Displays the vectors of a matrix of neurons.
+ * @brief Pass 1 of the loader: counts the non-empty lines that start in a slice of the file.
  *
- * This function iterates through the 2D matrix of neurons and prints each neuron's vector 
- * element by element. Each vector is displayed on a new line.
- *
- * @param dataMatrice A `ParamMatrice` structure containing the matrix of neurons.
- * @param tailleVec The size (dimension) of each neuron's vector to display.
- *
- * @note This function prints each vector of the neuron matrix in a row-major order.
+ * @param arg A pointer to the `TacheChargement` of the thread.
+ * @return NULL.
  */
-void afficherMatriceNeurone(ParamMatrice dataMatrice, int tailleVec){
-    int i,j,k;
+void * compterLignes(void * arg){
+    TacheChargement * tache = arg;
+    size_t position = debutLigneSuivante(tache->texte, tache->tailleTexte, tache->debut);
+    const char * saut;
+    size_t finLigne;
 
-    for(i=0; i<dataMatrice.largeur; i++){
-        for(j=0; j<dataMatrice.longueur; j++){
-            for(k=0; k<tailleVec; k++){
-                printf("%f ", dataMatrice.matrice[i][j].vecteur[k]);
-            }
-            printf("\n");
-        }
+    tache->nbLignes = 0;
+
+    while(position < tache->fin){
+        saut = memchr(tache->texte + position, '\n', tache->tailleTexte - position);
+        finLigne = (saut != NULL) ? (size_t)(saut - tache->texte) : tache->tailleTexte;
 
+        if(!ligneVide(tache->texte, position, finLigne)){
+            tache->nbLignes++;
+        }
+        position = finLigne + 1;
     }
 
+    return NULL;
 }
 
 
 /**
- * @brief Computes the Euclidean distance between a given vector and all the vectors in a neuron matrix.
- *
- * This function iterates through a 2D matrix of neurons and computes the Euclidean distance 
- * between a given vector and each neuron's vector. The distance is stored in the `distanceEuclidienne` 
- * attribute of each corresponding neuron in the matrix.
- *
- * @param vecteur The vector to compare with all vectors in the neuron matrix.
- * @param matrice The 2D matrix of neurons.
- * @param longueur The number of rows in the matrix (height).
- * @param largeur The number of columns in the matrix (width).
- * @param tailleVec The dimension (size) of each vector.
+ * @brief Parses one line of text: `tailleVec` numbers followed by the label.
  *
- * @note The computed distance is stored directly in the `distanceEuclidienne` field of each neuron.
+ * @param debut The first character of the line.
+ * @param finLigne The end of the line (position of the '\n' or end of the text).
+ * @param delimiteur The field delimiter.
+ * @param tailleVec The number of numeric fields.
+ * @param vecteur Output: the numeric fields (missing or invalid fields are set to 0).
+ * @param etiquette Output: the first character of the label, inside the line.
+ * @param longueur Output: the length of the label, without trailing blanks or carriage return.
+ * @return 1 if the line is malformed, 0 otherwise.
  */
-void distanceEuclidienneMatrice(double * vecteur, neurone ** matrice, int longueur, int largeur, int tailleVec){
-    int i, j, k=0;
-
-   for(i=0; i<largeur; i++){
-        for(j=0; j<longueur; j++){
-            matrice[i][j].distanceEuclidienne = distanceEuclidienne(vecteur, matrice[i][j].vecteur, tailleVec);
-            k++;
+int analyserLigne(const char * debut, const char * finLigne, char delimiteur, int tailleVec, reel * vecteur, const char ** etiquette, size_t * longueur){
+    const char * curseur = debut;
+    const char * suite;
+    int d, erreur = 0;
+
+    for(d=0; d<tailleVec; d++){
+        vecteur[d] = lireReel(curseur, finLigne, &suite);
+
+        if(suite == curseur || suite >= finLigne || *suite != delimiteur){
+            erreur = 1;
+            curseur = suite;
+            break;
         }
+        curseur = suite + 1;
+    }
+
+    for(d++; d<tailleVec; d++){
+        vecteur[d] = 0.0;
+    }
+
+    *longueur = (size_t)(finLigne - curseur);
+
+    while(*longueur > 0 && (curseur[*longueur-1] == '\r' || curseur[*longueur-1] == ' ')){
+        (*longueur)--;
     }
+
+    *etiquette = curseur;
+
+    return erreur;
 }
 
 
 /**
- * @brief Computes the Euclidean distance between two vectors.
+ * @brief Pass 2 of the loader: parses the lines of a slice straight into the feature matrix.
  *
- * This function calculates the Euclidean distance between two vectors in an n-dimensional space.
- * The distance is computed as the square root of the sum of squared differences between corresponding elements.
+ * The numbers of each line are written in the rows of the contiguous matrix starting at
+ * `premiereLigne` (see `analyserLigne`); the label is interned in the dictionary of the slice,
+ * whose indices are translated to the dictionary of the dataset once every slice is parsed.
  *
- * @param vecteur The first vector.
- * @param vector The second vector.
- * @param taille The dimension (number of elements) of the vectors.
- * @return The Euclidean distance between the two vectors.
+ * @param arg A pointer to the `TacheChargement` of the thread.
+ * @return NULL.
  */
-double distanceEuclidienne (double* vecteur, double* vector, int taille){
-    int i;
-    double distance = 0.0;
+void * analyserLignes(void * arg){
+    TacheChargement * tache = arg;
+    size_t position = debutLigneSuivante(tache->texte, tache->tailleTexte, tache->debut);
+    const char * saut;
+    const char * finLigne;
+    const char * etiquette;
+    long ligne = tache->premiereLigne;
+    size_t longueur;
+    dataset * donnee;
+
+    tache->nbErreurs = 0;
+    tache->dico = creerDictionnaire();
+
+    while(position < tache->fin){
+        saut = memchr(tache->texte + position, '\n', tache->tailleTexte - position);
+        finLigne = (saut != NULL) ? saut : tache->texte + tache->tailleTexte;
+
+        if(ligneVide(tache->texte, position, (size_t)(finLigne - tache->texte))){
+            position = (size_t)(finLigne - tache->texte) + 1;
+            continue;
+        }
 
+        donnee = &tache->data.mesDataset[ligne];
+        donnee->vecteur = tache->data.donnees + (size_t)ligne * tache->data.tailleVecPad;
+        tache->nbErreurs += analyserLigne(tache->texte + position, finLigne, tache->delimiteur, tache->data.tailleVec,
+                                          donnee->vecteur, &etiquette, &longueur);
 
-   for(i=0; i<taille; i++){
-        distance += pow( (vector[i] - vecteur[i]),2);
+        donnee->classe = internerEtiquette(&tache->dico, etiquette, longueur);
+
+        ligne++;
+        position = (size_t)(finLigne - tache->texte) + 1;
     }
 
-    distance = sqrt(distance);
-    return distance;
+    return NULL;
 }
 
 
 /**
- * @brief Performs the training process using the Self-Organizing Map (SOM) algorithm.
- *
- * This function simulates the learning process of the Self-Organizing Map (SOM) algorithm, where 
- * a dataset is progressively mapped to a matrix of neurons. The function adjusts the neurons' weights 
- * based on the Euclidean distance between the dataset vectors and the neurons in the matrix.
- * The learning rate (`alpha`) is progressively decreased, and the neighborhood size (`nbVoisin`) is adjusted
- * throughout the process.
- *
- * The training consists of two phases:
- * - **Phase 1:** In the first 20% of the training, the neighborhood size (`nbVoisin`) is gradually reduced
- *   from 3 to 1, and the learning rate (`alpha`) is decreased.
- * - **Phase 2:** In the remaining 80% of the training, the neighborhood size continues to decrease from 2 to 1,
- *   and the learning rate (`alpha`) is decreased further.
+ * @brief Reads a data file and stores its contents in a structured dataset.
  *
- * The function selects the Best Matching Unit (BMU) for each data point and performs learning based on the 
- * BMU’s position in the matrix.
+ * The file is mapped in memory and parsed in two parallel passes over `nbThreads` slices:
+ * the first one counts the non-empty lines of each slice, which gives the size of the dataset
+ * and the first row of every slice; the feature matrix is then allocated once, and the second
+ * pass parses each slice straight into its rows. The loading speed is printed.
  *
- * @param data A `paramDataset` structure containing the dataset to be mapped to the neuron matrix.
- * @param dataMatrice A `ParamMatrice` structure containing the matrix of neurons to be updated.
- * @param alpha The initial learning rate (alpha).
- * @param temps The number of iterations for training.
+ * @param nomFichier The name of the file to read (CSV or similar format).
+ * @param delimiteur The delimiter used to split each line (e.g., "," or "\t").
+ * @param nbThreads The number of threads used to parse the file.
+ * @return A fully populated `paramDataset` structure containing:
+ *         - an array of dataset entries, whose vectors are rows of a contiguous feature matrix,
+ *         - the size of the dataset,
+ *         - the dimension of the vectors,
+ *         - a placeholder for the mean vector.
  *
- * @note The function progressively decreases the learning rate and adjusts the neighborhood size during training.
- * The training operates in two phases, with three sub-phases within the first phase and two sub-phases in the second.
+ * @note Each line of the file is expected to contain a vector followed by a label.
+ *       The number of delimiter occurrences in the first line defines the vector size.
+ *       Blank lines are ignored.
+ * @warning If the file cannot be opened, a warning is printed to the console and
+ *          the returned structure is empty.
  */
-void rapprochement(paramDataset data, ParamMatrice dataMatrice, double alpha, int temps){
-    int i,j, index;
-    int phase = 0;
-    ParamListeChaine dataListeChaine;
-    Element * BMU;
-    double alphaDepart = alpha;
+paramDataset traitementFichier(char* nomFichier, char * delimiteur, int nbThreads){
+
+    size_t tailleTexte, finPremiere, position;
+    const char * texte;
+    const char * saut;
+    int t, k, nbDelimiteur = 0, nbErreurs = 0;
+    int parLigne = ALIGNEMENT_CACHE / sizeof(reel);
+    int * correspondance;
+    long nbDonnee = 0, ligne;
+    double debutChargement = chronometre(), duree;
+    TacheChargement * taches;
+    paramDataset paramGlobal;
 
+    memset(&paramGlobal, 0, sizeof(paramGlobal));
+    texte = projeterFichier(nomFichier, &tailleTexte);
 
-    for(i=0; i<temps; i++){
-        for(j=0; j<data.tailleTab; j++){
-            index = data.tabMelanger[j];
-            distanceEuclidienneMatrice(data.mesDataset[index].vecteur, dataMatrice.matrice, dataMatrice.longueur, dataMatrice.largeur, data.tailleVec);
-            dataListeChaine = rechercheBMU(dataMatrice);
-            BMU = randomElementListeBMU(dataListeChaine.lesBMU, dataListeChaine.tailleListeBMU);
-            //printf("BMU choisi %d %d\n", BMU->x, BMU->y);
+    if(texte == NULL){
+        printf("impossible d'ouvrir le fichier");
+        return paramGlobal;
+    }
 
-           if(i < ( (1.0/5.0) * temps ) ){  //phase 1
-                    phase = 1;
+    // calcul de la taille des vecteurs sur la premiere ligne
+    saut = memchr(texte, '\n', tailleTexte);
+    finPremiere = (saut != NULL) ? (size_t)(saut - texte) : tailleTexte;
 
-					if(i < (1.0/5.0) * temps /3 ){ // sous phase 1
-                        dataMatrice.nbVoisin = 3;
-					}
+    for(position=0; position<finPremiere; position++){
+        if(texte[position] == delimiteur[0]){
+            nbDelimiteur++;
+        }
+    }
 
-					if(i >= ( (1.0/5.0) * temps /3 ) && i < 2* ( (1.0/5.0) * temps  /3 ) ){ // sous phase 2
-                        dataMatrice.nbVoisin = 2;
-					}
+    if((size_t)nbThreads > tailleTexte / 65536 + 1){ // pas de thread pour les petits fichiers
+        nbThreads = (int)(tailleTexte / 65536) + 1;
+    }
 
-					if(i >= 2 * ( ( (1.0/5.0) * temps) /3 ) ){ //sous phase 3
-                        dataMatrice.nbVoisin = 1;
-					}
-				}
+    taches = malloc(nbThreads * sizeof(TacheChargement));
 
-				else{ // phase 2
-                    phase = 2;
-                    alpha = alpha/100;
+    for(t=0; t<nbThreads; t++){
+        taches[t].texte = texte;
+        taches[t].tailleTexte = tailleTexte;
+        taches[t].debut = tailleTexte * t / nbThreads;
+        taches[t].fin = tailleTexte * (t+1) / nbThreads;
+        taches[t].delimiteur = delimiteur[0];
+    }
 
-					if(i < (4/5) * temps /2 ){ //sous phase 1
-                        dataMatrice.nbVoisin = 2;
-					}
+    lancerThreads(nbThreads, compterLignes, taches, sizeof(TacheChargement));
 
-					if(i >= (4/5) * temps /2 ){ //sous phase 2
-                        dataMatrice.nbVoisin = 1;
-					}
-            }
+    for(t=0; t<nbThreads; t++){
+        taches[t].premiereLigne = nbDonnee;
+        nbDonnee += taches[t].nbLignes;
+    }
+
+    // remplissage des paramètres globale lié au dataset
+    paramGlobal.tailleTab = (int)nbDonnee;
+    paramGlobal.tailleVec = nbDelimiteur;
+    paramGlobal.tailleVecPad = (nbDelimiteur + parLigne - 1) / parLigne * parLigne;
+    paramGlobal.donnees = allocAligne((size_t)nbDonnee * paramGlobal.tailleVecPad * sizeof(reel));
+    memset(paramGlobal.donnees, 0, (size_t)nbDonnee * paramGlobal.tailleVecPad * sizeof(reel));
+    paramGlobal.mesDataset = malloc((nbDonnee > 0 ? nbDonnee : 1) * sizeof(dataset));
+    paramGlobal.vecteurMoyen = malloc(nbDelimiteur * sizeof(reel));
+
+    for(t=0; t<nbThreads; t++){
+        taches[t].data = paramGlobal;
+    }
 
-            // apprentissage
-            apprentissage(BMU, dataMatrice, alpha, data.tailleVec, dataMatrice.nbVoisin, data.mesDataset[index].vecteur);
+    lancerThreads(nbThreads, analyserLignes, taches, sizeof(TacheChargement));
 
-            // change le coef alpha
-            if( (phase == 1 && alpha > alphaDepart * 0.1) || (phase = 2 && alpha > (alphaDepart/100) * 0.1) ){
-                alpha = alphaDepart * (1 - (i/temps));
-            }
-       }
+    // fusion des dictionnaires des tranches, dans l'ordre du fichier
+    paramGlobal.dico = creerDictionnaire();
+
+    for(t=0; t<nbThreads; t++){
+        nbErreurs += taches[t].nbErreurs;
+        correspondance = malloc((taches[t].dico.nbNoms > 0 ? taches[t].dico.nbNoms : 1) * sizeof(int));
+
+        for(k=0; k<taches[t].dico.nbNoms; k++){
+            correspondance[k] = internerEtiquette(&paramGlobal.dico, taches[t].dico.noms[k], strlen(taches[t].dico.noms[k]));
+        }
+
+        for(ligne=taches[t].premiereLigne; ligne<taches[t].premiereLigne+taches[t].nbLignes; ligne++){
+            paramGlobal.mesDataset[ligne].classe = correspondance[paramGlobal.mesDataset[ligne].classe];
+        }
+
+        free(correspondance);
+        libererDictionnaire(taches[t].dico);
+    }
 
+    if(nbErreurs > 0){
+        printf("attention : %d ligne(s) mal formee(s) dans %s\n", nbErreurs, nomFichier);
     }
 
-    supprimerListe(dataListeChaine);
+    duree = chronometre() - debutChargement;
+    printf("chargement : %ld lignes en %.3f s (%.0f lignes/s)\n\n", nbDonnee, duree, (duree > 0.0) ? nbDonnee / duree : 0.0);
+
+    free(taches);
+    libererProjection(texte, tailleTexte);
 
+    return paramGlobal;
 }
 
 
 /**
- * @brief Searches for the Best Matching Unit (BMU) in a neuron matrix.
+ * @brief Creates an empty label dictionary.
  *
- * This function scans through the entire neuron matrix and finds the neuron (or neurons) that have the smallest 
- * Euclidean distance to the input vector. The neuron(s) with the minimum distance are considered the Best 
- * Matching Unit (BMU). The function also collects additional neurons that have the same minimum distance.
- *
- * The search is done in the entire matrix, and a linked list is created containing the coordinates (x, y) of 
- * the neurons that are identified as BMUs. The function returns a structure containing the linked list and the 
- * total number of BMUs found.
- *
- * @param dataMatrice A `ParamMatrice` structure containing the neuron matrix to be searched.
- *
- * @return A `ParamListeChaine` structure containing:
- * - `lesBMU`: A pointer to the linked list of BMU coordinates (x, y).
- * - `tailleListeBMU`: The number of BMUs found in the matrix.
+ * @return The new dictionary, to be released with `libererDictionnaire`.
+ */
+DictionnaireEtiquettes creerDictionnaire(void){
+    DictionnaireEtiquettes dico;
+
+    dico.nbNoms = 0;
+    dico.capaciteNoms = 8;
+    dico.noms = malloc(dico.capaciteNoms * sizeof(char*));
+    dico.tailleTable = 16;
+    dico.table = calloc(dico.tailleTable, sizeof(int));
+
+    return dico;
+}
+
+
+/**
+ * @brief Returns the index of a label, adding it to the dictionary the first time it is seen.
  *
- * @note The function uses the Euclidean distance between the input vector and the neuron vectors in the matrix 
- * to identify the BMU. If multiple neurons share the same minimum distance, they are all considered BMUs and 
- * added to the linked list.
+ * @param dico The dictionary.
+ * @param etiquette The label, not necessarily terminated (copied when it is added).
+ * @param longueur The length of the label.
+ * @return The index of the label, between 0 and `nbNoms - 1`.
  */
-ParamListeChaine rechercheBMU(ParamMatrice dataMatrice){
-    int i,j, x, y;
-    double distanceMin = dataMatrice.matrice[0][0].distanceEuclidienne;
-    Liste * listeChaine;
-    int tailleChaine = 0;
-    ParamListeChaine dataListeChaine;
+int internerEtiquette(DictionnaireEtiquettes * dico, const char * etiquette, size_t longueur){
+    uint32_t hache = 2166136261u; // FNV-1a
+    const char * c;
+    char * nom;
+    int k, position, masque;
+
+    for(c=etiquette; c<etiquette+longueur; c++){
+        hache = (hache ^ (unsigned char)*c) * 16777619u;
+    }
 
+    masque = dico->tailleTable - 1;
 
-    for(i=0; i<dataMatrice.largeur; i++){
-        for(j=1; j<dataMatrice.longueur; j++){
+    for(position = hache & masque; dico->table[position] != 0; position = (position + 1) & masque){
+        nom = dico->noms[dico->table[position] - 1];
 
-            if(dataMatrice.matrice[i][j].distanceEuclidienne < distanceMin){
-                distanceMin = dataMatrice.matrice[i][j].distanceEuclidienne;
-                x = i;
-                y = j;
-                tailleChaine = 1;
-            }
+        if(strncmp(nom, etiquette, longueur) == 0 && nom[longueur] == '\0'){
+            return dico->table[position] - 1;
         }
     }
 
-    //printf("BMU %d %d %f\n",x,y,distanceMin);
+    if(dico->nbNoms == dico->capaciteNoms){
+        dico->capaciteNoms *= 2;
+        dico->noms = realloc(dico->noms, dico->capaciteNoms * sizeof(char*));
+    }
+
+    dico->noms[dico->nbNoms] = malloc(longueur + 1);
+    memcpy(dico->noms[dico->nbNoms], etiquette, longueur);
+    dico->noms[dico->nbNoms][longueur] = '\0';
+    dico->table[position] = ++dico->nbNoms;
 
-    listeChaine = initialisationListe(x,y);
+    if(2 * dico->nbNoms > dico->tailleTable){ // agrandissement de la table
+        free(dico->table);
+        dico->tailleTable *= 2;
+        dico->table = calloc(dico->tailleTable, sizeof(int));
+        masque = dico->tailleTable - 1;
 
-     for(i=0; i<dataMatrice.largeur; i++){
-        for(j=0; j<dataMatrice.longueur; j++){
+        for(k=0; k<dico->nbNoms; k++){
+            hache = 2166136261u;
 
-            if(i!= x && j != y && dataMatrice.matrice[i][j].distanceEuclidienne == distanceMin){
-                ajouterElement(listeChaine, i, j);
-                tailleChaine++;
+            for(c=dico->noms[k]; *c!='\0'; c++){
+                hache = (hache ^ (unsigned char)*c) * 16777619u;
             }
+            for(position = hache & masque; dico->table[position] != 0; position = (position + 1) & masque){
+            }
+            dico->table[position] = k + 1;
         }
     }
 
-    dataListeChaine.lesBMU = listeChaine;
-    dataListeChaine.tailleListeBMU = tailleChaine;
-
-    return dataListeChaine;
+    return dico->nbNoms - 1;
 }
 
 
 /**
- * @brief Initializes a linked list for storing BMU coordinates.
- *
- * This function creates the first element of a linked list that will be used to store the coordinates (x, y) 
- * of Best Matching Units (BMUs). The first element is initialized with the provided values `a` (x-coordinate) 
- * and `b` (y-coordinate), and it is the only element in the list at the time of initialization.
- *
- * @param a The x-coordinate of the first BMU.
- * @param b The y-coordinate of the first BMU.
+ * @brief Releases a label dictionary.
  *
- * @return A pointer to a `Liste` structure that contains the first element of the list, with the coordinates 
- * (a, b), and the `suivant` pointer set to `NULL`.
- *
- * @note The function creates and returns a new linked list with a single element initialized to the 
- * provided coordinates. This element will be the first in the list, and the `suivant` pointer is set to `NULL`.
+ * @param dico The dictionary.
  */
-Liste * initialisationListe(int a, int b){
-
-    Liste * liste = malloc(sizeof(*liste));
-    Element * element = malloc(sizeof(*element));
+void libererDictionnaire(DictionnaireEtiquettes dico){
+    int k;
 
-    element->x = a;
-    element->y = b;
-    element->suivant = NULL;
-
-    liste->premier = element;
+    for(k=0; k<dico.nbNoms; k++){
+        free(dico.noms[k]);
+    }
 
-    return liste;
+    free(dico.noms);
+    free(dico.table);
 }
 
 
 /**
- * @brief Adds a new element to the beginning of the linked list.
- *
- * This function creates a new element with the given coordinates (a, b) and adds it to the front of the 
- * linked list. The new element becomes the first element of the list, with its `suivant` pointer 
- * pointing to the previous first element.
+ * @brief Writes a dataset in the binary dataset format.
  *
- * @param liste A pointer to the linked list where the new element will be added.
- * @param a The x-coordinate of the new element.
- * @param b The y-coordinate of the new element.
+ * The file holds an `EnteteDataset` header, the feature block exactly as it is laid out in
+ * memory (rows padded to `tailleVecPad`, block aligned on `ALIGNEMENT_CACHE` bytes), the class
+ * of each row and the table of the distinct labels. Loading it back with `chargerDatasetBinaire`
+ * needs no parsing at all.
  *
- * @note The new element is added to the front of the list. After the operation, the list's first element
- * is the newly added element, and its `suivant` pointer points to the previous first element.
+ * @param data The dataset to write (already normalized if `data.normalise` is set).
+ * @param nomFichier The name of the binary file to create.
+ * @return 0 on success, -1 if the file could not be written.
  */
-void ajouterElement(Liste * liste, int a, int b){
-    Element *nouveau = malloc(sizeof(*nouveau));
+int ecrireDatasetBinaire(paramDataset data, char * nomFichier){
+    FILE * fichier = fopen(nomFichier, "wb");
+    EnteteDataset entete;
+    DictionnaireEtiquettes dico = data.dico;
+    int32_t * classes = malloc((data.tailleTab > 0 ? data.tailleTab : 1) * sizeof(int32_t));
+    char bourrage[ALIGNEMENT_CACHE] = {0};
+    size_t longueur;
+    int i, k, erreur = 0;
+
+    if(fichier == NULL){
+        free(classes);
+        return -1;
+    }
+
+    for(i=0; i<data.tailleTab; i++){
+        classes[i] = data.mesDataset[i].classe;
+    }
+
+    memset(&entete, 0, sizeof(entete));
+    memcpy(entete.magie, MAGIE_DATASET, 4);
+    entete.version = VERSION_DATASET;
+    entete.nbLignes = (uint64_t)data.tailleTab;
+    entete.tailleVec = (uint32_t)data.tailleVec;
+    entete.tailleVecPad = (uint32_t)data.tailleVecPad;
+    entete.tailleReel = sizeof(reel);
+    entete.normalise = (uint32_t)data.normalise;
+    entete.positionDonnees = (sizeof(EnteteDataset) + ALIGNEMENT_CACHE - 1) / ALIGNEMENT_CACHE * ALIGNEMENT_CACHE;
+    entete.positionClasses = entete.positionDonnees + entete.nbLignes * entete.tailleVecPad * sizeof(reel);
+    entete.positionEtiquettes = entete.positionClasses + entete.nbLignes * sizeof(int32_t);
+    entete.nbEtiquettes = (uint32_t)dico.nbNoms;
+
+    erreur |= fwrite(&entete, sizeof(entete), 1, fichier) != 1;
+    longueur = entete.positionDonnees - sizeof(entete);
+    erreur |= fwrite(bourrage, 1, longueur, fichier) != longueur;
+
+    if(data.tailleTab > 0){
+        erreur |= fwrite(data.donnees, sizeof(reel) * data.tailleVecPad, data.tailleTab, fichier) != (size_t)data.tailleTab;
+        erreur |= fwrite(classes, sizeof(int32_t), data.tailleTab, fichier) != (size_t)data.tailleTab;
+    }
 
-    nouveau->x = a;
-    nouveau->y = b;
-    nouveau->suivant = liste->premier;
+    for(k=0; k<dico.nbNoms; k++){
+        longueur = strlen(dico.noms[k]) + 1;
+        erreur |= fwrite(dico.noms[k], 1, longueur, fichier) != longueur;
+    }
+
+    erreur |= fclose(fichier) != 0;
+    free(classes);
 
-    liste->premier = nouveau;
+    return erreur ? -1 : 0;
 }
 
+
 /**
- * @brief Frees the memory used by the linked list.
- *
- * This function traverses the linked list and frees the memory allocated for each element. It starts by 
- * freeing the first element and continues until all elements are removed from the list.
+ * @brief Tells whether a block of a mapped file lies inside a range of offsets.
  *
- * @param dataListe A structure containing the linked list (`lesBMU`) to be deleted.
+ * The products are never formed, so a corrupted header cannot overflow them.
  *
- * @note This function assumes that the linked list is not empty. After calling this function, the memory 
- * used by the entire linked list will be deallocated. The list will no longer be accessible.
+ * @param position The offset of the block.
+ * @param nbElements The number of elements of the block.
+ * @param tailleElement The size in bytes of one element.
+ * @param debut The first offset the block may use.
+ * @param fin One past the last offset the block may use.
+ * @return 1 if the block lies between `debut` and `fin`, 0 otherwise.
  */
-
-void supprimerListe(ParamListeChaine dataListe) {
-    Element *actuel = dataListe.lesBMU->premier;
-    Element *suivant;
-    while (actuel != NULL) {
-        suivant = actuel->suivant;
-        free(actuel);
-        actuel = suivant;
+int blocDansFichier(uint64_t position, uint64_t nbElements, uint64_t tailleElement, uint64_t debut, uint64_t fin){
+    if(position < debut || position > fin){
+        return 0;
     }
+
+    return tailleElement == 0 || nbElements <= (fin - position) / tailleElement;
 }
 
+
 /**
- * @brief Returns a pointer to a random element from the linked list.
- *
- * This function selects a random element from the provided linked list by generating a random index.
- * It then traverses the list until the corresponding element is found and returns a pointer to that element.
+ * @brief Reads the label table of a mapped file (NUL-terminated strings) into a dictionary.
  *
- * @param listeChaine A pointer to the linked list from which the random element will be chosen.
- * @param tailleListe The total number of elements in the linked list.
- *
- * @return A pointer to the randomly chosen element from the list.
- *
- * @note If the list is empty or the size is incorrect, this function may lead to undefined behavior.
+ * @param debut The first character of the table.
+ * @param fin One past the last character of the mapping.
+ * @param nbEtiquettes The number of labels of the table.
+ * @param dico The dictionary receiving the labels.
+ * @return 0 on success, -1 if a label is not terminated before `fin` or appears twice
+ *         (the class indices of the file would not match the dictionary).
  */
-Element * randomElementListeBMU(Liste * listeChaine, int tailleListe){
-    int i;
-    int index = rand()%tailleListe;
-    Element * elementActuel = listeChaine->premier;
-    Element * BMUchoisi;
+int lireTableEtiquettes(const char * debut, const char * fin, uint32_t nbEtiquettes, DictionnaireEtiquettes * dico){
+    const char * nom = debut;
+    const char * zero;
+    uint32_t k;
 
-    for(i=0; i<=index; i++){
-        BMUchoisi = elementActuel;
+    for(k=0; k<nbEtiquettes; k++){
+        zero = (nom < fin) ? memchr(nom, '\0', fin - nom) : NULL;
 
-        if(elementActuel->suivant != NULL){
-            elementActuel = elementActuel->suivant;
+        if(zero == NULL || internerEtiquette(dico, nom, zero - nom) != (int)k){
+            return -1;
         }
+        nom = zero + 1;
     }
 
-    return BMUchoisi;
+    return 0;
 }
 
+
 /**
- * @brief Performs the learning (weight update) for the BMU (Best Matching Unit) and its neighbors.
- *
- * This function updates the weights of the neurons in the matrix based on the difference between
- * the BMU's vector and the provided input vector. The update is performed for the BMU and its neighbors
- * within a specified radius (defined by `voisin`). The learning rate (`alpha`) is used to control
- * the magnitude of the weight updates.
- *
- * @param BMU A pointer to the BMU (Best Matching Unit) element whose weights will be updated.
- * @param dataMatrice The matrix of neurons to be updated.
- * @param alpha The learning rate, which controls the size of the weight updates.
- * @param tailleVec The dimension of the vector (i.e., the number of elements in each neuron's vector).
- * @param voisin The radius around the BMU within which the neighbors' weights will be updated.
- * @param dataVec The input vector to be used for the learning process.
+ * @brief Tells whether a file is a binary dataset (starts with `MAGIE_DATASET`).
  *
- * @note The function updates the weights of neurons that are within the specified radius (`voisin`) from the BMU.
- *       If the radius is too large, it may cause more neurons to be affected by the update.
- *       The learning rate (`alpha`) is used to control how much the weights are adjusted during each learning step.
+ * @param nomFichier The name of the file.
+ * @return 1 for a binary dataset, 0 otherwise.
  */
-void apprentissage(Element * BMU, ParamMatrice dataMatrice, double alpha, int tailleVec, int voisin, double * dataVec){
-    int i,j,k;
-    double val = 0.0;
-
-
-    for(i=0; i<dataMatrice.largeur; i++){
-        for(j=0; j<dataMatrice.longueur; j++){
-
-            if(i <= (BMU->x + voisin) && i >= (BMU->x - voisin) ){
-                if(j <= (BMU->y + voisin) && j >= (BMU->y - voisin) ){
-
-                    for(k=0; k<tailleVec; k++){
-                        val = dataMatrice.matrice[i][j].vecteur[k] + alpha * (dataVec[k] - dataMatrice.matrice[i][j].vecteur[k]);
-                        dataMatrice.matrice[i][j].vecteur[k] = val;
-                    }
-                }
-
-            }
-
-        }
+int estDatasetBinaire(char * nomFichier){
+    FILE * fichier = fopen(nomFichier, "rb");
+    char magie[4];
+    int resultat = 0;
+
+    if(fichier != NULL){
+        resultat = fread(magie, 1, 4, fichier) == 4 && memcmp(magie, MAGIE_DATASET, 4) == 0;
+        fclose(fichier);
     }
 
+    return resultat;
 }
 
 
 /**
- * @brief Assigns labels to the neurons in the matrix based on the closest dataset vector.
+ * @brief Loads a binary dataset written by `ecrireDatasetBinaire` without copying it.
  *
- * This function computes the Euclidean distance between each neuron's vector in the matrix and 
- * each dataset vector, and assigns the label of the closest dataset vector to the neuron.
- * This process effectively labels the neurons based on the dataset.
+ * The file is mapped privately (copy-on-write) and the feature block of the mapping is used
+ * directly as the `donnees` matrix of the dataset; the class of each data point is read from the
+ * class block and the label table fills the dictionary. Only the array of `dataset` entries is
+ * built, no number is parsed. The header is checked before anything is read through it: every
+ * block must fit, in order, between its offset and the next one, and every class and label
+ * must be valid.
  *
- * @param dataMatrice The matrix of neurons that will be labeled.
- * @param data The dataset containing the vectors and their corresponding labels.
+ * @param nomFichier The name of the binary file.
+ * @return The dataset, or an empty dataset if the file is missing or invalid
+ *         (a message is printed).
  *
- * @note The function uses the Euclidean distance to find the closest dataset vector for each neuron,
- *       and assigns the label of the closest dataset vector to the neuron.
+ * @note The mapping is released by `freeAll`. Writes to the vectors (normalization) only
+ *       touch private pages, the file itself is never modified.
  */
-void putEtiquette(ParamMatrice dataMatrice, paramDataset data){
-    int i,j,k;
-    double tab[data.tailleTab];
-    int indexBMU;
+paramDataset chargerDatasetBinaire(char * nomFichier){
+    paramDataset data;
+    EnteteDataset entete;
+    int32_t * classes;
+    uint64_t i;
+    int erreur;
+    double debutChargement = chronometre(), duree;
+#ifndef _WIN32
+    int descripteur;
+    struct stat infos;
+    void * contenu;
+#endif
+
+    memset(&data, 0, sizeof(data));
+
+#ifndef _WIN32
+    descripteur = open(nomFichier, O_RDONLY);
+
+    if(descripteur < 0 || fstat(descripteur, &infos) != 0 || (size_t)infos.st_size < sizeof(EnteteDataset)){
+        if(descripteur >= 0){
+            close(descripteur);
+        }
+        printf("impossible d'ouvrir le fichier");
+        return data;
+    }
 
-    for(i=0; i<dataMatrice.largeur; i++){
+    contenu = mmap(NULL, (size_t)infos.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, descripteur, 0);
+    close(descripteur);
+
+    if(contenu == MAP_FAILED){
+        printf("impossible d'ouvrir le fichier");
+        return data;
+    }
+
+    data.projection = contenu;
+    data.tailleProjection = (size_t)infos.st_size;
+#else
+    data.projection = (char*)projeterFichier(nomFichier, &data.tailleProjection);
+
+    if(data.projection == NULL || data.tailleProjection < sizeof(EnteteDataset)){
+        printf("impossible d'ouvrir le fichier");
+        return data;
+    }
+#endif
+
+    memcpy(&entete, data.projection, sizeof(entete));
+
+    if(memcmp(entete.magie, MAGIE_DATASET, 4) != 0 || entete.version != VERSION_DATASET
+       || entete.positionDonnees % ALIGNEMENT_CACHE != 0 || entete.positionClasses % sizeof(int32_t) != 0
+       || entete.nbLignes > INT_MAX || entete.tailleVec == 0 || entete.tailleVecPad < entete.tailleVec){
+        printf("fichier %s : format de dataset binaire non reconnu\n", nomFichier);
+        libererProjection(data.projection, data.tailleProjection);
+        data.projection = NULL;
+        return data;
+    }
+
+    if(entete.tailleReel != sizeof(reel)){
+        printf("fichier %s : valeurs sur %u octets, ce programme est compile pour %u octets (SOM_FLOAT32)\n",
+               nomFichier, entete.tailleReel, (unsigned)sizeof(reel));
+        libererProjection(data.projection, data.tailleProjection);
+        data.projection = NULL;
+        return data;
+    }
+
+    classes = (int32_t*)(data.projection + entete.positionClasses);
+
+    // blocs dans l'ordre, chacun avant le debut du suivant
+    erreur = !blocDansFichier(entete.positionDonnees, entete.nbLignes, (uint64_t)entete.tailleVecPad * sizeof(reel), sizeof(EnteteDataset), entete.positionClasses)
+             || !blocDansFichier(entete.positionClasses, entete.nbLignes, sizeof(int32_t), entete.positionDonnees, entete.positionEtiquettes)
+             || !blocDansFichier(entete.positionEtiquettes, 0, 1, entete.positionClasses, data.tailleProjection);
+
+    for(i=0; i<entete.nbLignes && !erreur; i++){
+        erreur = classes[i] < -1 || classes[i] >= (int64_t)entete.nbEtiquettes;
+    }
+
+    data.dico = creerDictionnaire();
+    erreur = erreur || lireTableEtiquettes(data.projection + entete.positionEtiquettes, data.projection + data.tailleProjection,
+                                           entete.nbEtiquettes, &data.dico) != 0;
+
+    if(erreur){
+        printf("fichier %s : dataset binaire corrompu\n", nomFichier);
+        libererDictionnaire(data.dico);
+        libererProjection(data.projection, data.tailleProjection);
+        memset(&data, 0, sizeof(data));
+        return data;
+    }
+
+    data.tailleTab = (int)entete.nbLignes;
+    data.tailleVec = (int)entete.tailleVec;
+    data.tailleVecPad = (int)entete.tailleVecPad;
+    data.normalise = (int)entete.normalise;
+    data.donnees = (reel*)(data.projection + entete.positionDonnees);
+    data.vecteurMoyen = malloc(data.tailleVec * sizeof(reel));
+    data.mesDataset = malloc((data.tailleTab > 0 ? data.tailleTab : 1) * sizeof(dataset));
+
+    for(i=0; i<entete.nbLignes; i++){
+        data.mesDataset[i].vecteur = data.donnees + i * entete.tailleVecPad;
+        data.mesDataset[i].norme = 0.0;
+        data.mesDataset[i].classe = classes[i];
+    }
+
+    duree = chronometre() - debutChargement;
+    printf("chargement : %d lignes en %.3f s (%.0f lignes/s)\n\n", data.tailleTab, duree, (duree > 0.0) ? data.tailleTab / duree : 0.0);
+
+    return data;
+}
+
+
+/**
+ * @brief Writes a trained and labelled map in the trained model format.
+ *
+ * The file holds an `EnteteModele` header and the blocks it describes, each one exactly as it is
+ * laid out in memory, so `chargerModele` only maps the file. The squared norms of the neurons
+ * are recomputed before writing.
+ *
+ * @param dataMatrice The trained and labelled neuron matrix.
+ * @param vecteurMoyen The mean vector of the training set.
+ * @param dico The label dictionary the classes of the map refer to.
+ * @param nomFichier The name of the model file to create.
+ * @return 0 on success, -1 if the file could not be written.
+ */
+int ecrireModele(ParamMatrice dataMatrice, reel * vecteurMoyen, DictionnaireEtiquettes dico, char * nomFichier){
+    FILE * fichier = fopen(nomFichier, "wb");
+    EnteteModele entete;
+    int32_t * entiers = malloc(dataMatrice.nbNeurone * sizeof(int32_t));
+    reel * moyenne = calloc(dataMatrice.tailleVecPad, sizeof(reel));
+    char bourrage[ALIGNEMENT_CACHE] = {0};
+    size_t longueur, bloc = (size_t)dataMatrice.nbNeurone * dataMatrice.tailleVecPad * sizeof(reel);
+    uint64_t position;
+    int k, erreur = 0;
+
+    if(fichier == NULL){
+        free(entiers);
+        free(moyenne);
+        return -1;
+    }
+
+    rafraichirNormes(dataMatrice, 0, dataMatrice.nbNeurone);
+    memcpy(moyenne, vecteurMoyen, dataMatrice.tailleVec * sizeof(reel));
+
+    memset(&entete, 0, sizeof(entete));
+    memcpy(entete.magie, MAGIE_MODELE, 4);
+    entete.version = VERSION_MODELE;
+    entete.largeur = (uint32_t)dataMatrice.largeur;
+    entete.longueur = (uint32_t)dataMatrice.longueur;
+    entete.topologie = 0;
+    entete.voisinage = (uint32_t)dataMatrice.voisinage;
+    entete.tailleVec = (uint32_t)dataMatrice.tailleVec;
+    entete.tailleVecPad = (uint32_t)dataMatrice.tailleVecPad;
+    entete.tailleReel = sizeof(reel);
+    entete.nbEtiquettes = (uint32_t)dico.nbNoms;
+    entete.positionPoids = (sizeof(EnteteModele) + ALIGNEMENT_CACHE - 1) / ALIGNEMENT_CACHE * ALIGNEMENT_CACHE;
+    entete.positionNormes = entete.positionPoids + bloc;
+    entete.positionPuretes = entete.positionNormes + dataMatrice.nbNeurone * sizeof(double);
+    entete.positionMoyenne = entete.positionPuretes + dataMatrice.nbNeurone * sizeof(double);
+    entete.positionClasses = entete.positionMoyenne + dataMatrice.tailleVecPad * sizeof(reel);
+    entete.positionImpacts = entete.positionClasses + dataMatrice.nbNeurone * sizeof(int32_t);
+    entete.positionEtiquettes = entete.positionImpacts + dataMatrice.nbNeurone * sizeof(int32_t);
+    position = entete.positionEtiquettes;
+
+    for(k=0; k<dico.nbNoms; k++){
+        position += strlen(dico.noms[k]) + 1;
+    }
+    entete.tailleFichier = position;
+
+    erreur |= fwrite(&entete, sizeof(entete), 1, fichier) != 1;
+    longueur = entete.positionPoids - sizeof(entete);
+    erreur |= fwrite(bourrage, 1, longueur, fichier) != longueur;
+    erreur |= fwrite(dataMatrice.poids, 1, bloc, fichier) != bloc;
+    erreur |= fwrite(dataMatrice.normes, sizeof(double), dataMatrice.nbNeurone, fichier) != (size_t)dataMatrice.nbNeurone;
+    erreur |= fwrite(dataMatrice.purete, sizeof(double), dataMatrice.nbNeurone, fichier) != (size_t)dataMatrice.nbNeurone;
+    erreur |= fwrite(moyenne, sizeof(reel), dataMatrice.tailleVecPad, fichier) != (size_t)dataMatrice.tailleVecPad;
+
+    for(k=0; k<dataMatrice.nbNeurone; k++){
+        entiers[k] = dataMatrice.classes[k];
+    }
+    erreur |= fwrite(entiers, sizeof(int32_t), dataMatrice.nbNeurone, fichier) != (size_t)dataMatrice.nbNeurone;
+
+    for(k=0; k<dataMatrice.nbNeurone; k++){
+        entiers[k] = dataMatrice.impacts[k];
+    }
+    erreur |= fwrite(entiers, sizeof(int32_t), dataMatrice.nbNeurone, fichier) != (size_t)dataMatrice.nbNeurone;
+
+    for(k=0; k<dico.nbNoms; k++){
+        longueur = strlen(dico.noms[k]) + 1;
+        erreur |= fwrite(dico.noms[k], 1, longueur, fichier) != longueur;
+    }
+
+    erreur |= fclose(fichier) != 0;
+    free(entiers);
+    free(moyenne);
+
+    return erreur ? -1 : 0;
+}
+
+
+/**
+ * @brief Maps a trained model written by `ecrireModele`, ready for BMU queries.
+ *
+ * The file is mapped read-only and shared, so concurrent processes using the same model share
+ * its pages and a load costs the mapping and the checks, whatever the dimension of the data.
+ * Before anything is read through the header, every block must fit, in order, between its offset
+ * and the next one, every class must be in [-1, nbEtiquettes) and every label must end inside the
+ * file. The codebook, norms, purities, classes and impacts of the map are then used in place; the
+ * label table fills the dictionary.
+ *
+ * @param nomFichier The name of the model file.
+ * @return The model, with a NULL `projection` if the file is missing or invalid (a message is printed).
+ *
+ * @note The mapping is released by `libererModele`. The map must not be trained or relabelled.
+ */
+Modele chargerModele(char * nomFichier){
+    Modele modele;
+    EnteteModele entete;
+    const int32_t * classes;
+    uint64_t nbNeurone, k;
+    int erreur;
+#ifndef _WIN32
+    int descripteur;
+    struct stat infos;
+    void * contenu;
+#endif
+
+    memset(&modele, 0, sizeof(modele));
+
+#ifndef _WIN32
+    descripteur = open(nomFichier, O_RDONLY);
+
+    if(descripteur < 0 || fstat(descripteur, &infos) != 0 || (size_t)infos.st_size < sizeof(EnteteModele)){
+        if(descripteur >= 0){
+            close(descripteur);
+        }
+        printf("impossible d'ouvrir le modele %s\n", nomFichier);
+        return modele;
+    }
+
+    contenu = mmap(NULL, (size_t)infos.st_size, PROT_READ, MAP_SHARED, descripteur, 0);
+    close(descripteur);
+
+    if(contenu == MAP_FAILED){
+        printf("impossible d'ouvrir le modele %s\n", nomFichier);
+        return modele;
+    }
+
+    modele.projection = contenu;
+    modele.tailleProjection = (size_t)infos.st_size;
+#else
+    modele.projection = (char*)projeterFichier(nomFichier, &modele.tailleProjection);
+
+    if(modele.projection == NULL || modele.tailleProjection < sizeof(EnteteModele)){
+        printf("impossible d'ouvrir le modele %s\n", nomFichier);
+        modele.projection = NULL;
+        return modele;
+    }
+#endif
+
+    memcpy(&entete, modele.projection, sizeof(entete));
+
+    if(memcmp(entete.magie, MAGIE_MODELE, 4) != 0 || entete.version != VERSION_MODELE || entete.topologie != 0
+       || entete.positionPoids % ALIGNEMENT_CACHE != 0 || entete.tailleFichier != modele.tailleProjection
+       || entete.largeur == 0 || entete.longueur == 0 || (uint64_t)entete.largeur * entete.longueur > INT_MAX
+       || entete.tailleVec == 0 || entete.tailleVecPad < entete.tailleVec || entete.voisinage > VOISINAGE_CHAPEAU_MEXICAIN
+       || entete.positionNormes % sizeof(double) != 0 || entete.positionPuretes % sizeof(double) != 0
+       || entete.positionMoyenne % sizeof(reel) != 0 || entete.positionClasses % sizeof(int32_t) != 0
+       || entete.positionImpacts % sizeof(int32_t) != 0){
+        printf("fichier %s : format de modele non reconnu\n", nomFichier);
+        libererProjection(modele.projection, modele.tailleProjection);
+        modele.projection = NULL;
+        return modele;
+    }
+
+    if(entete.tailleReel != sizeof(reel)){
+        printf("fichier %s : valeurs sur %u octets, ce programme est compile pour %u octets (SOM_FLOAT32)\n",
+               nomFichier, entete.tailleReel, (unsigned)sizeof(reel));
+        libererProjection(modele.projection, modele.tailleProjection);
+        modele.projection = NULL;
+        return modele;
+    }
+
+    // blocs dans l'ordre, chacun avant le debut du suivant
+    nbNeurone = (uint64_t)entete.largeur * entete.longueur;
+    erreur = !blocDansFichier(entete.positionPoids, nbNeurone, (uint64_t)entete.tailleVecPad * sizeof(reel), sizeof(EnteteModele), entete.positionNormes)
+             || !blocDansFichier(entete.positionNormes, nbNeurone, sizeof(double), entete.positionPoids, entete.positionPuretes)
+             || !blocDansFichier(entete.positionPuretes, nbNeurone, sizeof(double), entete.positionNormes, entete.positionMoyenne)
+             || !blocDansFichier(entete.positionMoyenne, entete.tailleVec, sizeof(reel), entete.positionPuretes, entete.positionClasses)
+             || !blocDansFichier(entete.positionClasses, nbNeurone, sizeof(int32_t), entete.positionMoyenne, entete.positionImpacts)
+             || !blocDansFichier(entete.positionImpacts, nbNeurone, sizeof(int32_t), entete.positionClasses, entete.positionEtiquettes)
+             || !blocDansFichier(entete.positionEtiquettes, 0, 1, entete.positionImpacts, entete.tailleFichier);
+    classes = (const int32_t*)(modele.projection + entete.positionClasses);
+
+    for(k=0; k<nbNeurone && !erreur; k++){
+        erreur = classes[k] < -1 || classes[k] >= (int64_t)entete.nbEtiquettes;
+    }
+
+    modele.dico = creerDictionnaire();
+    erreur = erreur || lireTableEtiquettes(modele.projection + entete.positionEtiquettes, modele.projection + modele.tailleProjection,
+                                           entete.nbEtiquettes, &modele.dico) != 0;
+
+    if(erreur){
+        printf("fichier %s : modele corrompu\n", nomFichier);
+        libererDictionnaire(modele.dico);
+        libererProjection(modele.projection, modele.tailleProjection);
+        memset(&modele, 0, sizeof(modele));
+        return modele;
+    }
+
+    memset(&modele.carte, 0, sizeof(modele.carte));
+    modele.carte.largeur = (int)entete.largeur;
+    modele.carte.longueur = (int)entete.longueur;
+    modele.carte.nbNeurone = modele.carte.largeur * modele.carte.longueur;
+    modele.carte.tailleVec = (int)entete.tailleVec;
+    modele.carte.tailleVecPad = (int)entete.tailleVecPad;
+    modele.carte.poids = (reel*)(modele.projection + entete.positionPoids);
+    modele.carte.normes = (double*)(modele.projection + entete.positionNormes);
+    modele.carte.purete = (double*)(modele.projection + entete.positionPuretes);
+    modele.carte.classes = (int*)(modele.projection + entete.positionClasses);
+    modele.carte.impacts = (int*)(modele.projection + entete.positionImpacts);
+    modele.carte.distances = allocAligne(modele.carte.nbNeurone * sizeof(double));
+    modele.carte.suivi = NULL;
+    modele.carte.esquisse = NULL;
+    modele.carte.mesure = NULL;
+    modele.carte.generateur = NULL;
+    modele.carte.abandon = 0;
+    modele.carte.noyauDistance = choisirNoyauDistance();
+    modele.carte.noyauProduit = choisirNoyauProduit();
+    modele.carte.voisinage = (typeVoisinage)entete.voisinage;
+    modele.carte.tableVoisinage = NULL;
+    modele.carte.rayonTable = -1;
+    modele.vecteurMoyen = (reel*)(modele.projection + entete.positionMoyenne);
+
+    return modele;
+}
+
+
+/**
+ * @brief Releases a model mapped by `chargerModele`.
+ *
+ * @param modele The model.
+ */
+void libererModele(Modele modele){
+    if(modele.projection == NULL){
+        return;
+    }
+
+    libererAligne(modele.carte.distances);
+    libererDictionnaire(modele.dico);
+    libererProjection(modele.projection, modele.tailleProjection);
+}
+
+
+/**
+ * @brief Displays the contents of a dataset array in a formatted manner.
+ *
+ * This function prints each dataset entry line by line, displaying the vector values
+ * separated by commas, followed by the corresponding label.
+ *
+ * @param nbVecteur The number of data entries in the dataset.
+ * @param tailleVecteur The size of each feature vector.
+ * @param mesData A pointer to the array of dataset structures to display.
+ * @param dico The label dictionary of the dataset.
+ *
+ * @note The output format is: `value1,value2,...,valueN,label`
+ */
+void afficherData(int nbVecteur, int tailleVecteur, dataset *mesData, DictionnaireEtiquettes dico){
+    int i,j;
+
+    for(i=0;i<nbVecteur;i++){
+        for(j=0;j<tailleVecteur;j++){
+            printf("%f",mesData[i].vecteur[j]);
+
+            if(j<tailleVecteur-1){
+                printf(",");
+            }
+        }
+        printf(",%s", (mesData[i].classe >= 0) ? dico.noms[mesData[i].classe] : "");
+        printf("\n");
+    }
+}
+
+
+/**
+ * @brief Displays the weight vectors of a block of neurons.
+ *
+ * This function iterates through a contiguous weight block and prints each neuron's
+ * vector components separated by commas.
+ *
+ * @param nbVecteur The number of neurons to display.
+ * @param tailleVecteur The size of each neuron's weight vector.
+ * @param pas The row stride of the weight block (padded vector size).
+ * @param poids A pointer to the first weight of the block.
+ *
+ * @note Only the vector components are printed; labels and distances are not displayed.
+ * @warning The output includes an extra comma before the newline due to redundant printf calls.
+ */
+void afficherVecteurNeurone(int nbVecteur, int tailleVecteur, int pas, reel *poids){
+    int i,j;
+
+    for(i=0;i<nbVecteur;i++){
+        for(j=0;j<tailleVecteur;j++){
+            printf("%f,",poids[(size_t)i*pas + j]);
+
+            if(j<tailleVecteur-1){
+                printf(",");
+            }
+        }
+        printf("\n");
+    }
+}
+
+
+/**
+ * @brief Normalizes the feature vectors of a dataset.
+ *
+ * This function computes the Euclidean norm of each vector in the dataset
+ * and normalizes each component by dividing it by the corresponding norm.
+ * The normalization is done in-place.
+ *
+ * @param mesStructure A pointer to the dataset array to normalize.
+ * @param tailleVecteur The size (dimension) of each feature vector.
+ * @param nbVecteur The number of vectors in the dataset.
+ * @return A pointer to the same dataset array, now with normalized vectors.
+ *
+ * @note This function modifies the input dataset directly. The norm of each vector
+ *       before normalization is kept in its `norme` field.
+ */
+dataset * NormaliserVecteur(dataset * mesStructure, int tailleVecteur, int nbVecteur){
+    int i,j;
+    double norme;
+
+    for(i=0; i<nbVecteur; i++){
+        norme = 0.0;
+
+        for(j=0; j<tailleVecteur; j++){
+            norme += mesStructure[i].vecteur[j] * mesStructure[i].vecteur[j];
+        }
+
+        norme = sqrt(norme);
+        mesStructure[i].norme = norme;
+
+
+        for(j=0; j<tailleVecteur; j++){
+            mesStructure[i].vecteur[j] = (mesStructure[i].vecteur[j]/norme);
+        }
+
+    }
+
+    return mesStructure;
+
+}
+
+
+/**
+ * @brief Computes the mean vector from a dataset.
+ *
+ * This function calculates the component-wise average of all vectors in the dataset
+ * and stores the result in the provided `vecteurMoyen` array.
+ *
+ * @param mesStructure A pointer to the dataset array.
+ * @param tailleVecteur The size (dimension) of each feature vector.
+ * @param nbVecteur The number of vectors in the dataset.
+ * @param vecteurMoyen A pointer to a pre-allocated array where the resulting mean vector will be stored.
+ *
+ * @note The mean is computed across all dataset entries for each vector component.
+ * @warning The array `vecteurMoyen` must be allocated before calling this function.
+ */
+void vecteurMoyen(dataset * mesStructure, int tailleVecteur, int nbVecteur, reel * vecteurMoyen){
+    int i,j;
+    double somme = 0.0;
+
+    for(i=0;i<tailleVecteur;i++){
+        for(j=0;j<nbVecteur;j++){
+            somme += mesStructure[j].vecteur[i];
+        }
+        vecteurMoyen[i] = somme/nbVecteur;
+        somme = 0.0;
+        //printf("%f\n", vecteurMoyen[i]);
+    }
+}
+
+
+/**
+ * @brief Allocates a block of memory aligned on a cache line.
+ *
+ * The requested size is rounded up to a multiple of `ALIGNEMENT_CACHE`, as
+ * required by `aligned_alloc`. The block must be released with `libererAligne`.
+ *
+ * @param taille The number of bytes to allocate.
+ * @return A pointer to the aligned block, or NULL if the allocation failed.
+ */
+void * allocAligne(size_t taille){
+    taille = (taille + ALIGNEMENT_CACHE - 1) / ALIGNEMENT_CACHE * ALIGNEMENT_CACHE;
+
+    if(taille == 0){
+        taille = ALIGNEMENT_CACHE;
+    }
+
+#ifdef _WIN32
+    return _aligned_malloc(taille, ALIGNEMENT_CACHE);
+#else
+    return aligned_alloc(ALIGNEMENT_CACHE, taille);
+#endif
+}
+
+
+/**
+ * @brief Releases a block allocated with `allocAligne`.
+ *
+ * @param bloc The block to release (may be NULL).
+ */
+void libererAligne(void * bloc){
+#ifdef _WIN32
+    _aligned_free(bloc);
+#else
+    free(bloc);
+#endif
+}
+
+
+/**
+ * @brief Advances a splitmix64 sequence and returns its next value.
+ *
+ * Used to spread a seed over the state of a `Generateur`: consecutive seeds give unrelated states.
+ *
+ * @param x The state of the sequence, advanced by one step.
+ * @return The next value of the sequence.
+ */
+uint64_t etendreGraine(uint64_t * x){
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ull);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+
+    return z ^ (z >> 31);
+}
+
+
+/**
+ * @brief Creates a pseudo-random generator from a seed.
+ *
+ * @param graine The seed (any value, zero included).
+ * @return The generator.
+ */
+Generateur creerGenerateur(uint64_t graine){
+    Generateur generateur;
+    int k;
+
+    for(k=0; k<4; k++){
+        generateur.etat[k] = etendreGraine(&graine);
+    }
+
+    return generateur;
+}
+
+
+/**
+ * @brief Draws 64 random bits (xoshiro256**).
+ *
+ * @param generateur The generator.
+ * @return The draw.
+ */
+uint64_t tirerGenerateur(Generateur * generateur){
+    uint64_t * s = generateur->etat;
+    uint64_t resultat = s[1] * 5;
+    uint64_t t = s[1] << 17;
+
+    resultat = ((resultat << 7) | (resultat >> 57)) * 9;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = (s[3] << 45) | (s[3] >> 19);
+
+    return resultat;
+}
+
+
+/**
+ * @brief Draws an integer uniformly in [0, borne).
+ *
+ * Multiplies 32 random bits by the bound and keeps the high half, rejecting the few draws
+ * that would bias the result (Lemire's method): no division on the common path.
+ *
+ * @param generateur The generator.
+ * @param borne The number of possible values (at least 1).
+ * @return The draw.
+ */
+uint32_t tirerBorne(Generateur * generateur, uint32_t borne){
+    uint64_t produit = (tirerGenerateur(generateur) >> 32) * borne;
+    uint32_t seuil;
+
+    if((uint32_t)produit < borne){
+        seuil = -borne % borne;
+
+        while((uint32_t)produit < seuil){
+            produit = (tirerGenerateur(generateur) >> 32) * borne;
+        }
+    }
+
+    return (uint32_t)(produit >> 32);
+}
+
+
+/**
+ * @brief Draws a real number uniformly in [0, 1), with 53 random bits.
+ *
+ * @param generateur The generator.
+ * @return The draw.
+ */
+double tirerUniforme(Generateur * generateur){
+    return (tirerGenerateur(generateur) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+
+/**
+ * @brief Moves a generator 2^128 draws ahead.
+ *
+ * Applying it t times to copies of one generator gives the streams of t threads,
+ * which cannot overlap in any realistic run.
+ *
+ * @param generateur The generator.
+ */
+void sauterGenerateur(Generateur * generateur){
+    static const uint64_t saut[4] = {0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull, 0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull};
+    uint64_t etat[4] = {0, 0, 0, 0};
+    int k, b;
+
+    for(k=0; k<4; k++){
+        for(b=0; b<64; b++){
+            if(saut[k] & (1ull << b)){
+                etat[0] ^= generateur->etat[0];
+                etat[1] ^= generateur->etat[1];
+                etat[2] ^= generateur->etat[2];
+                etat[3] ^= generateur->etat[3];
+            }
+            tirerGenerateur(generateur);
+        }
+    }
+
+    memcpy(generateur->etat, etat, sizeof(etat));
+}
+
+
+/**
+ * @brief Checks the generator against the reference implementation of xoshiro256**.
+ *
+ * From the state {1, 2, 3, 4}, one jump then one draw must give the values of the reference
+ * `jump()` and `next()`: a wrong jump constant would make the thread streams overlap silently.
+ *
+ * @return 0 if the generator matches the reference, -1 otherwise.
+ */
+int verifierGenerateur(void){
+    static const uint64_t attendu[4] = {0x8C7A153956B5F3D1ull, 0x701F1A713401D85Eull, 0x6527F66A65469085ull, 0x8386B786C4408050ull};
+    Generateur generateur = {{1, 2, 3, 4}};
+
+    sauterGenerateur(&generateur);
+
+    if(memcmp(generateur.etat, attendu, sizeof(attendu)) != 0){
+        return -1;
+    }
+
+    return tirerGenerateur(&generateur) == 0xBBD2F312298443D8ull ? 0 : -1;
+}
+
+
+/**
+ * @brief Shuffles an array of indices in place (Fisher–Yates).
+ *
+ * @param indices The array to shuffle.
+ * @param nb The number of indices.
+ * @param generateur The generator.
+ */
+void melangerIndices(int * indices, int nb, Generateur * generateur){
+    int k, d, tmp;
+
+    for(k=nb-1; k>0; k--){
+        d = (int)tirerBorne(generateur, (uint32_t)k + 1);
+        tmp = indices[k];
+        indices[k] = indices[d];
+        indices[d] = tmp;
+    }
+}
+
+
+/**
+ * @brief Fills the codebook of a neuron matrix with random vectors based on a mean vector.
+ *
+ * The random values are uniformly distributed between `vecteurMoyen[i] - min` and `vecteurMoyen[i] + max`
+ * for each component `i`. The neurons are filled row by row in the contiguous weight block,
+ * and the padding at the end of each row is left at zero.
+ *
+ * @param dataMatrice The matrix whose weight block (allocated by `genererMatriceNeurone`) is filled;
+ *                    the values are drawn from its `generateur`.
+ * @param min The minimum offset from the mean for random generation.
+ * @param max The maximum offset from the mean for random generation.
+ * @param vecteurMoyen The reference mean vector used to center the random values.
+ */
+void genereVecteurDouble(ParamMatrice dataMatrice, double min, double max, reel* vecteurMoyen){
+
+    int i,j;
+    int tailleVecteurs = dataMatrice.tailleVec;
+    double * borneSupp = (double*)malloc(sizeof(double) * tailleVecteurs);
+    double * borneInf = (double*)malloc(sizeof(double) * tailleVecteurs);
+    reel * vecteur;
+
+
+    for(i=0; i<tailleVecteurs; i++){
+        borneInf[i] = vecteurMoyen[i] - min;
+        borneSupp[i] = vecteurMoyen[i] + max;
+
+    }
+
+    for(i=0;i<dataMatrice.nbNeurone;i++){
+        vecteur = dataMatrice.poids + (size_t)i * dataMatrice.tailleVecPad;
+
+        for(j=0;j<tailleVecteurs;j++){
+            vecteur[j]= tirerUniforme(dataMatrice.generateur) * (borneSupp[j] - borneInf[j]) + borneInf[j];
+
+            //printf("%f;",vecteur[j]);
+        }
+        //printf("\n");
+    }
+
+    free(borneInf);
+    free(borneSupp);
+
+    rafraichirNormes(dataMatrice, 0, dataMatrice.nbNeurone);
+}
+
+
+/**
+ * @brief Generates a shuffled array of indices for the dataset.
+ *
+ * This function initializes an array of indices from 0 to `nbVecteur - 1`
+ * and shuffles them with `melangerIndices`.
+ *
+ * @param nbVecteur The number of data points (size of the dataset).
+ * @param generateur The generator of the shuffle.
+ * @return A pointer to an array of shuffled indices.
+ *
+ * @note The returned array must be freed by the caller.
+ */
+int * indiceMelange(int nbVecteur, Generateur * generateur){
+
+    int * indexAleatoire = malloc(sizeof(int)*nbVecteur);
+    int i;
+
+
+    for(i=0; i<nbVecteur; i++){
+        indexAleatoire[i]=i;
+
+    }
+
+    melangerIndices(indexAleatoire, nbVecteur, generateur);
+
+    return indexAleatoire;
+}
+
+
+/**
+ * @brief Allocates the codebook of a neuron matrix.
+ *
+ * The matrix dimensions are computed so that the width is set to one-tenth of the total number
+ * of neurons (`nbNeurone / 10`), and the height is derived accordingly, which rounds the number of
+ * neurons down to a multiple of 10. All the weights are then allocated in a single cache-aligned
+ * block whose rows are padded to a multiple of `ALIGNEMENT_CACHE` bytes; the distances and the
+ * labels get their own parallel arrays.
+ *
+ * @param dataMatrice A `ParamMatrice` structure, partially filled and passed by value.
+ * @param nbNeurone The requested number of neurons.
+ * @param tailleVec The dimension of each neuron's vector.
+ * @return The updated `ParamMatrice` structure with its (zeroed) weight block.
+ *
+ * @note Caller is responsible for freeing the matrix afterward (see `freeAll`).
+ * @note A request for fewer than 10 neurons gets 10 (a single row of the grid).
+ */
+ParamMatrice genererMatriceNeurone(ParamMatrice dataMatrice, int nbNeurone, int tailleVec){
+    size_t tailleBloc;
+    int k, parLigne = ALIGNEMENT_CACHE / sizeof(reel);
+
+    if(nbNeurone < 10){ // sinon largeur nulle
+        nbNeurone = 10;
+    }
+
+    dataMatrice.largeur = nbNeurone/10;
+    dataMatrice.longueur = nbNeurone/dataMatrice.largeur;
+    dataMatrice.nbNeurone = dataMatrice.largeur * dataMatrice.longueur;
+    dataMatrice.tailleVec = tailleVec;
+    dataMatrice.tailleVecPad = (tailleVec + parLigne - 1) / parLigne * parLigne;
+
+    tailleBloc = (size_t)dataMatrice.nbNeurone * dataMatrice.tailleVecPad * sizeof(reel);
+    dataMatrice.poids = allocAligne(tailleBloc);
+    memset(dataMatrice.poids, 0, tailleBloc);
+
+    dataMatrice.distances = allocAligne(dataMatrice.nbNeurone * sizeof(double));
+    dataMatrice.normes = allocAligne(dataMatrice.nbNeurone * sizeof(double));
+    memset(dataMatrice.normes, 0, dataMatrice.nbNeurone * sizeof(double));
+    dataMatrice.classes = malloc(dataMatrice.nbNeurone * sizeof(int));
+    dataMatrice.impacts = calloc(dataMatrice.nbNeurone, sizeof(int));
+    dataMatrice.suivi = NULL;
+    dataMatrice.esquisse = NULL;
+    dataMatrice.mesure = NULL;
+    dataMatrice.generateur = NULL;
+    dataMatrice.abandon = 0;
+    dataMatrice.purete = calloc(dataMatrice.nbNeurone, sizeof(double));
+
+    for(k=0; k<dataMatrice.nbNeurone; k++){
+        dataMatrice.classes[k] = -1;
+    }
+    dataMatrice.noyauDistance = choisirNoyauDistance();
+    dataMatrice.noyauProduit = choisirNoyauProduit();
+    dataMatrice.voisinage = VOISINAGE_BULLE;
+    dataMatrice.tableVoisinage = NULL;
+    dataMatrice.rayonTable = -1;
+
+    return dataMatrice;
+}
+
+
+/**
+ * @brief Returns the weight vector of the neuron at grid position (i, j).
+ *
+ * @param dataMatrice The neuron matrix.
+ * @param i The row index of the neuron.
+ * @param j The column index of the neuron.
+ * @return A pointer to the neuron's row in the weight block.
+ */
+reel * vecteurNeurone(ParamMatrice dataMatrice, int i, int j){
+    return dataMatrice.poids + ((size_t)i * dataMatrice.longueur + j) * dataMatrice.tailleVecPad;
+}
+
+
+/**
+ * @brief Returns the number of processors available to the program.
+ *
+ * @return The number of online processors (at least 1).
+ */
+int nombreProcesseurs(void){
+    long nb = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return (nb > 0) ? (int)nb : 1;
+}
+
+
+/**
+ * @brief Runs a function on several threads and waits for all of them.
+ *
+ * Thread t receives a pointer to the t-th element of the `taches` array. The last
+ * task runs on the calling thread, so a single task creates no thread at all.
+ *
+ * @param nbThreads The number of tasks (and threads).
+ * @param fonction The function executed by each thread.
+ * @param taches The array of tasks, one per thread.
+ * @param tailleTache The size in bytes of one task.
+ */
+void lancerThreads(int nbThreads, void * (*fonction)(void*), void * taches, size_t tailleTache){
+    int t;
+    pthread_t * threads = malloc(nbThreads * sizeof(pthread_t));
+
+    for(t=0; t<nbThreads-1; t++){
+        pthread_create(&threads[t], NULL, fonction, (char*)taches + t * tailleTache);
+    }
+
+    fonction((char*)taches + (nbThreads-1) * tailleTache);
+
+    for(t=0; t<nbThreads-1; t++){
+        pthread_join(threads[t], NULL);
+    }
+
+    free(threads);
+}
+
+
+/**
+ * @brief Displays the vectors of a matrix of neurons.
+ *
+ * This function iterates through the 2D matrix of neurons and prints each neuron's vector 
+ * element by element. Each vector is displayed on a new line.
+ *
+ * @param dataMatrice A `ParamMatrice` structure containing the matrix of neurons.
+ * @param tailleVec The size (dimension) of each neuron's vector to display.
+ *
+ * @note This function prints each vector of the neuron matrix in a row-major order.
+ */
+void afficherMatriceNeurone(ParamMatrice dataMatrice, int tailleVec){
+    int i,j,k;
+
+    for(i=0; i<dataMatrice.largeur; i++){
         for(j=0; j<dataMatrice.longueur; j++){
-            for(k=0; k<data.tailleTab; k++){
-                tab[k] = distanceEuclidienne(dataMatrice.matrice[i][j].vecteur, data.mesDataset[k].vecteur, data.tailleVec);
+            for(k=0; k<tailleVec; k++){
+                printf("%f ", vecteurNeurone(dataMatrice, i, j)[k]);
+            }
+            printf("\n");
+        }
+
+    }
+
+}
+
+
+/**
+ * @brief Computes the squared Euclidean distance between a given vector and all the vectors in a neuron matrix.
+ *
+ * This function streams through the contiguous weight block with the SIMD kernel selected for
+ * the matrix and stores the squared distance of each neuron in the `distances` array, at the
+ * neuron's index. The square root is not taken: the BMU search only compares these values.
+ *
+ * @param vecteur The vector to compare with all vectors in the neuron matrix.
+ * @param dataMatrice The neuron matrix.
+ */
+void distanceEuclidienneMatrice(reel * vecteur, ParamMatrice dataMatrice){
+    int k;
+    reel * poids = dataMatrice.poids;
+
+    for(k=0; k<dataMatrice.nbNeurone; k++){
+        dataMatrice.distances[k] = dataMatrice.noyauDistance(vecteur, poids, dataMatrice.tailleVec);
+        poids += dataMatrice.tailleVecPad;
+    }
+
+    if(dataMatrice.mesure != NULL){
+        dataMatrice.mesure->compteurs.nbDistances += dataMatrice.nbNeurone;
+    }
+}
+
+
+/**
+ * @brief Computes the Euclidean distance between two vectors.
+ *
+ * This function calculates the Euclidean distance between two vectors in an n-dimensional space.
+ * The distance is computed as the square root of the sum of squared differences between corresponding elements.
+ *
+ * @param vecteur The first vector.
+ * @param vector The second vector.
+ * @param taille The dimension (number of elements) of the vectors.
+ * @return The Euclidean distance between the two vectors.
+ */
+double distanceEuclidienne (reel* vecteur, reel* vector, int taille){
+    return sqrt(distanceCarreScalaire(vecteur, vector, taille));
+}
+
+
+/**
+ * @brief Computes the squared Euclidean distance between two vectors (portable version).
+ *
+ * @param a The first vector.
+ * @param b The second vector.
+ * @param taille The dimension of the vectors.
+ * @return The sum of the squared differences between corresponding elements.
+ */
+double distanceCarreScalaire(const reel* a, const reel* b, int taille){
+    int i;
+    double ecart;
+    double distance = 0.0;
+
+    for(i=0; i<taille; i++){
+        ecart = (double)b[i] - a[i];
+        distance += ecart * ecart;
+    }
+
+    return distance;
+}
+
+
+#ifdef SOM_X86
+/**
+ * @brief Squared Euclidean distance, SSE2 version (2 doubles per instruction, floats are widened).
+ *
+ * @param a The first vector.
+ * @param b The second vector.
+ * @param taille The dimension of the vectors.
+ * @return The squared distance between the two vectors.
+ */
+__attribute__((target("sse2")))
+double distanceCarreSSE2(const reel* a, const reel* b, int taille){
+    int i = 0;
+#ifdef SOM_FLOAT32
+    double somme[2];
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd(), ecart;
+    __m128 va, vb;
+
+    for(; i+4<=taille; i+=4){
+        va = _mm_loadu_ps(a+i);
+        vb = _mm_loadu_ps(b+i);
+        ecart = _mm_sub_pd(_mm_cvtps_pd(vb), _mm_cvtps_pd(va));
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(ecart, ecart));
+        ecart = _mm_sub_pd(_mm_cvtps_pd(_mm_movehl_ps(vb, vb)), _mm_cvtps_pd(_mm_movehl_ps(va, va)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(ecart, ecart));
+    }
+
+    _mm_storeu_pd(somme, _mm_add_pd(acc0, acc1));
+    somme[0] += somme[1];
+#else
+    double somme[2];
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd(), ecart;
+
+    for(; i+4<=taille; i+=4){
+        ecart = _mm_sub_pd(_mm_loadu_pd(b+i), _mm_loadu_pd(a+i));
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(ecart, ecart));
+        ecart = _mm_sub_pd(_mm_loadu_pd(b+i+2), _mm_loadu_pd(a+i+2));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(ecart, ecart));
+    }
+
+    _mm_storeu_pd(somme, _mm_add_pd(acc0, acc1));
+    somme[0] += somme[1];
+#endif
+
+    for(; i<taille; i++){
+        somme[0] += ((double)b[i] - a[i]) * ((double)b[i] - a[i]);
+    }
+
+    return somme[0];
+}
+
+
+/**
+ * @brief Squared Euclidean distance, AVX2/FMA version (4 doubles per instruction, floats are widened).
+ *
+ * @param a The first vector.
+ * @param b The second vector.
+ * @param taille The dimension of the vectors.
+ * @return The squared distance between the two vectors.
+ */
+__attribute__((target("avx2,fma")))
+double distanceCarreAVX2(const reel* a, const reel* b, int taille){
+    int i = 0;
+#ifdef SOM_FLOAT32
+    double somme[4];
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd(), ecart;
+
+    for(; i+8<=taille; i+=8){
+        ecart = _mm256_sub_pd(_mm256_cvtps_pd(_mm_loadu_ps(b+i)), _mm256_cvtps_pd(_mm_loadu_ps(a+i)));
+        acc0 = _mm256_fmadd_pd(ecart, ecart, acc0);
+        ecart = _mm256_sub_pd(_mm256_cvtps_pd(_mm_loadu_ps(b+i+4)), _mm256_cvtps_pd(_mm_loadu_ps(a+i+4)));
+        acc1 = _mm256_fmadd_pd(ecart, ecart, acc1);
+    }
+
+    for(; i+4<=taille; i+=4){
+        ecart = _mm256_sub_pd(_mm256_cvtps_pd(_mm_loadu_ps(b+i)), _mm256_cvtps_pd(_mm_loadu_ps(a+i)));
+        acc0 = _mm256_fmadd_pd(ecart, ecart, acc0);
+    }
+
+    _mm256_storeu_pd(somme, _mm256_add_pd(acc0, acc1));
+    somme[0] += somme[1] + somme[2] + somme[3];
+#else
+    double somme[4];
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd(), ecart;
+
+    for(; i+8<=taille; i+=8){
+        ecart = _mm256_sub_pd(_mm256_loadu_pd(b+i), _mm256_loadu_pd(a+i));
+        acc0 = _mm256_fmadd_pd(ecart, ecart, acc0);
+        ecart = _mm256_sub_pd(_mm256_loadu_pd(b+i+4), _mm256_loadu_pd(a+i+4));
+        acc1 = _mm256_fmadd_pd(ecart, ecart, acc1);
+    }
+
+    for(; i+4<=taille; i+=4){
+        ecart = _mm256_sub_pd(_mm256_loadu_pd(b+i), _mm256_loadu_pd(a+i));
+        acc0 = _mm256_fmadd_pd(ecart, ecart, acc0);
+    }
+
+    _mm256_storeu_pd(somme, _mm256_add_pd(acc0, acc1));
+    somme[0] += somme[1] + somme[2] + somme[3];
+#endif
+
+    for(; i<taille; i++){
+        somme[0] += ((double)b[i] - a[i]) * ((double)b[i] - a[i]);
+    }
+
+    return somme[0];
+}
+
+
+/**
+ * @brief Squared Euclidean distance, AVX-512 version (8 doubles per instruction, floats are widened).
+ *
+ * The tail of the vectors is handled with a masked load, so there is no scalar loop.
+ *
+ * @param a The first vector.
+ * @param b The second vector.
+ * @param taille The dimension of the vectors.
+ * @return The squared distance between the two vectors.
+ */
+__attribute__((target("avx512f")))
+double distanceCarreAVX512(const reel* a, const reel* b, int taille){
+    int i = 0;
+#ifdef SOM_FLOAT32
+    __mmask16 masque;
+    __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd(), ecart;
+
+    for(; i+16<=taille; i+=16){
+        ecart = _mm512_sub_pd(_mm512_cvtps_pd(_mm256_loadu_ps(b+i)), _mm512_cvtps_pd(_mm256_loadu_ps(a+i)));
+        acc0 = _mm512_fmadd_pd(ecart, ecart, acc0);
+        ecart = _mm512_sub_pd(_mm512_cvtps_pd(_mm256_loadu_ps(b+i+8)), _mm512_cvtps_pd(_mm256_loadu_ps(a+i+8)));
+        acc1 = _mm512_fmadd_pd(ecart, ecart, acc1);
+    }
+
+    for(; i<taille; i+=8){ // 8 floats par masque : la moitie basse du registre suffit
+        masque = (taille - i >= 8) ? 0xFF : (__mmask16)((1u << (taille - i)) - 1);
+        ecart = _mm512_sub_pd(_mm512_cvtps_pd(_mm512_castps512_ps256(_mm512_maskz_loadu_ps(masque, b+i))),
+                              _mm512_cvtps_pd(_mm512_castps512_ps256(_mm512_maskz_loadu_ps(masque, a+i))));
+        acc0 = _mm512_fmadd_pd(ecart, ecart, acc0);
+    }
+
+    return _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+#else
+    __mmask8 masque;
+    __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd(), ecart;
+
+    for(; i+16<=taille; i+=16){
+        ecart = _mm512_sub_pd(_mm512_loadu_pd(b+i), _mm512_loadu_pd(a+i));
+        acc0 = _mm512_fmadd_pd(ecart, ecart, acc0);
+        ecart = _mm512_sub_pd(_mm512_loadu_pd(b+i+8), _mm512_loadu_pd(a+i+8));
+        acc1 = _mm512_fmadd_pd(ecart, ecart, acc1);
+    }
+
+    for(; i<taille; i+=8){
+        masque = (taille - i >= 8) ? 0xFF : (__mmask8)((1u << (taille - i)) - 1);
+        ecart = _mm512_sub_pd(_mm512_maskz_loadu_pd(masque, b+i), _mm512_maskz_loadu_pd(masque, a+i));
+        acc0 = _mm512_fmadd_pd(ecart, ecart, acc0);
+    }
+
+    return _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+#endif
+}
+#endif
+
+
+/**
+ * @brief Selects the fastest squared distance kernel supported by the running CPU.
+ *
+ * The choice is made at runtime from the CPUID flags (AVX-512, then AVX2/FMA, then SSE2),
+ * so a single binary uses the widest instruction set available. The portable scalar
+ * kernel is used on other architectures.
+ *
+ * @return A pointer to the selected kernel.
+ */
+noyauDistanceCarre choisirNoyauDistance(void){
+#ifdef SOM_X86
+    __builtin_cpu_init();
+
+    if(__builtin_cpu_supports("avx512f")){
+        return distanceCarreAVX512;
+    }
+
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){
+        return distanceCarreAVX2;
+    }
+
+    if(__builtin_cpu_supports("sse2")){
+        return distanceCarreSSE2;
+    }
+#endif
+
+    return distanceCarreScalaire;
+}
+
+
+/**
+ * @brief Tile dot product kernel, portable version.
+ *
+ * @param x Pointers to the 4 sample rows of the tile.
+ * @param w Pointers to the 4 neuron rows of the tile.
+ * @param nbDim The number of components to multiply.
+ * @param produits Output: the 16 dot products, row-major (sample, neuron).
+ */
+void produitTuileScalaire(const reel* const* x, const reel* const* w, int nbDim, double* produits){
+    int i, j, d;
+    double somme;
+
+    for(i=0; i<4; i++){
+        for(j=0; j<4; j++){
+            somme = 0.0;
+
+            for(d=0; d<nbDim; d++){
+                somme += (double)x[i][d] * w[j][d];
+            }
+            produits[i*4 + j] = somme;
+        }
+    }
+}
+
+
+#ifdef SOM_X86
+/**
+ * @brief Tile dot product kernel, AVX2/FMA version.
+ *
+ * The tile is computed as two 4 x 2 halves so the 8 accumulators and the loaded
+ * rows fit in the 16 vector registers.
+ *
+ * @param x Pointers to the 4 sample rows of the tile.
+ * @param w Pointers to the 4 neuron rows of the tile.
+ * @param nbDim The number of components to multiply (multiple of the vector width).
+ * @param produits Output: the 16 dot products, row-major (sample, neuron).
+ */
+__attribute__((target("avx2,fma")))
+void produitTuileAVX2(const reel* const* x, const reel* const* w, int nbDim, double* produits){
+    int i, j, d;
+#ifdef SOM_FLOAT32
+    double somme[4];
+    __m256d acc[4][2], vx, w0, w1;
+
+    for(j=0; j<4; j+=2){
+        for(i=0; i<4; i++){
+            acc[i][0] = _mm256_setzero_pd();
+            acc[i][1] = _mm256_setzero_pd();
+        }
+
+        for(d=0; d<nbDim; d+=4){
+            w0 = _mm256_cvtps_pd(_mm_loadu_ps(w[j] + d));
+            w1 = _mm256_cvtps_pd(_mm_loadu_ps(w[j+1] + d));
+
+            for(i=0; i<4; i++){
+                vx = _mm256_cvtps_pd(_mm_loadu_ps(x[i] + d));
+                acc[i][0] = _mm256_fmadd_pd(vx, w0, acc[i][0]);
+                acc[i][1] = _mm256_fmadd_pd(vx, w1, acc[i][1]);
+            }
+        }
+
+        for(i=0; i<4; i++){
+            _mm256_storeu_pd(somme, acc[i][0]);
+            produits[i*4 + j] = (somme[0] + somme[1]) + (somme[2] + somme[3]);
+            _mm256_storeu_pd(somme, acc[i][1]);
+            produits[i*4 + j+1] = (somme[0] + somme[1]) + (somme[2] + somme[3]);
+        }
+    }
+#else
+    double somme[4];
+    __m256d acc[4][2], vx, w0, w1;
+
+    for(j=0; j<4; j+=2){
+        for(i=0; i<4; i++){
+            acc[i][0] = _mm256_setzero_pd();
+            acc[i][1] = _mm256_setzero_pd();
+        }
+
+        for(d=0; d<nbDim; d+=4){
+            w0 = _mm256_loadu_pd(w[j] + d);
+            w1 = _mm256_loadu_pd(w[j+1] + d);
+
+            for(i=0; i<4; i++){
+                vx = _mm256_loadu_pd(x[i] + d);
+                acc[i][0] = _mm256_fmadd_pd(vx, w0, acc[i][0]);
+                acc[i][1] = _mm256_fmadd_pd(vx, w1, acc[i][1]);
+            }
+        }
+
+        for(i=0; i<4; i++){
+            _mm256_storeu_pd(somme, acc[i][0]);
+            produits[i*4 + j] = (somme[0] + somme[1]) + (somme[2] + somme[3]);
+            _mm256_storeu_pd(somme, acc[i][1]);
+            produits[i*4 + j+1] = (somme[0] + somme[1]) + (somme[2] + somme[3]);
+        }
+    }
+#endif
+}
+
+
+/**
+ * @brief Tile dot product kernel, AVX-512 version (16 accumulators).
+ *
+ * @param x Pointers to the 4 sample rows of the tile.
+ * @param w Pointers to the 4 neuron rows of the tile.
+ * @param nbDim The number of components to multiply (multiple of the vector width).
+ * @param produits Output: the 16 dot products, row-major (sample, neuron).
+ */
+__attribute__((target("avx512f")))
+void produitTuileAVX512(const reel* const* x, const reel* const* w, int nbDim, double* produits){
+    int i, j, d;
+#ifdef SOM_FLOAT32
+    __m512d acc[4][4], vx, vw[4];
+
+    for(i=0; i<4; i++){
+        for(j=0; j<4; j++){
+            acc[i][j] = _mm512_setzero_pd();
+        }
+    }
+
+    for(d=0; d<nbDim; d+=8){
+        for(j=0; j<4; j++){
+            vw[j] = _mm512_cvtps_pd(_mm256_loadu_ps(w[j] + d));
+        }
+
+        for(i=0; i<4; i++){
+            vx = _mm512_cvtps_pd(_mm256_loadu_ps(x[i] + d));
+
+            for(j=0; j<4; j++){
+                acc[i][j] = _mm512_fmadd_pd(vx, vw[j], acc[i][j]);
+            }
+        }
+    }
+
+    for(i=0; i<4; i++){
+        for(j=0; j<4; j++){
+            produits[i*4 + j] = _mm512_reduce_add_pd(acc[i][j]);
+        }
+    }
+#else
+    __m512d acc[4][4], vx, vw[4];
+
+    for(i=0; i<4; i++){
+        for(j=0; j<4; j++){
+            acc[i][j] = _mm512_setzero_pd();
+        }
+    }
+
+    for(d=0; d<nbDim; d+=8){
+        for(j=0; j<4; j++){
+            vw[j] = _mm512_loadu_pd(w[j] + d);
+        }
+
+        for(i=0; i<4; i++){
+            vx = _mm512_loadu_pd(x[i] + d);
+
+            for(j=0; j<4; j++){
+                acc[i][j] = _mm512_fmadd_pd(vx, vw[j], acc[i][j]);
+            }
+        }
+    }
+
+    for(i=0; i<4; i++){
+        for(j=0; j<4; j++){
+            produits[i*4 + j] = _mm512_reduce_add_pd(acc[i][j]);
+        }
+    }
+#endif
+}
+#endif
+
+
+/**
+ * @brief Selects the tile dot product kernel supported by the running CPU.
+ *
+ * @return A pointer to the selected kernel.
+ */
+noyauProduitTuile choisirNoyauProduit(void){
+#ifdef SOM_X86
+    __builtin_cpu_init();
+
+    if(__builtin_cpu_supports("avx512f")){
+        return produitTuileAVX512;
+    }
+
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){
+        return produitTuileAVX2;
+    }
+#endif
+
+    return produitTuileScalaire;
+}
+
+
+/**
+ * @brief Recomputes the cached squared norm of a range of neurons.
+ *
+ * @param dataMatrice The neuron matrix.
+ * @param debut The first neuron to refresh.
+ * @param fin One past the last neuron to refresh.
+ */
+void rafraichirNormes(ParamMatrice dataMatrice, int debut, int fin){
+    int k, d;
+    double somme;
+    reel * vecteur;
+
+    for(k=debut; k<fin; k++){
+        vecteur = dataMatrice.poids + (size_t)k * dataMatrice.tailleVecPad;
+        somme = 0.0;
+
+        for(d=0; d<dataMatrice.tailleVec; d++){
+            somme += vecteur[d] * vecteur[d];
+        }
+        dataMatrice.normes[k] = somme;
+    }
+}
+
+
+/**
+ * @brief Packs a mini-batch of data points into a contiguous, padded block.
+ *
+ * @param data The dataset.
+ * @param indices The indices of the data points of the mini-batch (NULL for `debut`, `debut`+1, ...).
+ * @param debut The first data point when `indices` is NULL.
+ * @param tailleLot The number of data points in the mini-batch.
+ * @param lot Output: the packed block (tailleLot x tailleVecPad, padding set to zero).
+ * @param normesLot Output: the squared norm of each packed data point.
+ */
+void preparerLot(paramDataset data, int * indices, int debut, int tailleLot, reel * lot, double * normesLot){
+    int b, d, pas;
+    int parLigne = ALIGNEMENT_CACHE / sizeof(reel);
+    reel * source;
+    double somme;
+
+    pas = (data.tailleVec + parLigne - 1) / parLigne * parLigne;
+
+    for(b=0; b<tailleLot; b++){
+        source = data.mesDataset[(indices != NULL) ? indices[b] : debut + b].vecteur;
+        somme = 0.0;
+
+        for(d=0; d<data.tailleVec; d++){
+            lot[(size_t)b*pas + d] = source[d];
+            somme += source[d] * source[d];
+        }
+        for(; d<pas; d++){
+            lot[(size_t)b*pas + d] = 0.0;
+        }
+        normesLot[b] = somme;
+    }
+}
+
+
+/**
+ * @brief Computes the squared distances between a mini-batch of data points and every neuron.
+ *
+ * The distances are obtained as ||x||^2 - 2 x.w + ||w||^2 from the cached neuron norms and
+ * the dot products of the batch with the codebook, which is a matrix product. The product is
+ * blocked so a slice of `BLOC_NEURONES` neurons and `BLOC_DIMENSIONS` components stays in cache
+ * while every data point of the batch goes through it, and each 4 x 4 tile is computed in
+ * registers by the SIMD kernel of the matrix. The arithmetic intensity grows with the size of
+ * the batch, where `distanceEuclidienneMatrice` reads the whole codebook for every data point.
+ *
+ * @param lot The packed mini-batch (tailleLot x tailleVecPad), see `preparerLot`.
+ * @param normesLot The squared norm of each data point of the mini-batch.
+ * @param tailleLot The number of data points in the mini-batch.
+ * @param dataMatrice The neuron matrix, with up to date norms.
+ * @param resultat Output: the squared distances (tailleLot x nbNeurone, row-major).
+ *
+ * @note Rounding can make the expanded form slightly negative for an exact match; such values are set to 0.
+ */
+void distancesLot(const reel * lot, const double * normesLot, int tailleLot, ParamMatrice dataMatrice, double * resultat){
+    int b, n, i, j, debutNeurone, finNeurone, debutDim, nbDim;
+    int nbNeurone = dataMatrice.nbNeurone;
+    int pas = dataMatrice.tailleVecPad;
+    const reel * x[4];
+    const reel * w[4];
+    double produits[16];
+
+    if(dataMatrice.mesure != NULL){
+        dataMatrice.mesure->compteurs.nbDistances += (long)tailleLot * nbNeurone;
+    }
+
+    for(b=0; b<tailleLot; b++){
+        for(n=0; n<nbNeurone; n++){
+            resultat[(size_t)b*nbNeurone + n] = normesLot[b] + dataMatrice.normes[n];
+        }
+    }
+
+    for(debutNeurone=0; debutNeurone<nbNeurone; debutNeurone+=BLOC_NEURONES){
+        finNeurone = (debutNeurone + BLOC_NEURONES < nbNeurone) ? debutNeurone + BLOC_NEURONES : nbNeurone;
+
+        for(debutDim=0; debutDim<pas; debutDim+=BLOC_DIMENSIONS){
+            nbDim = (debutDim + BLOC_DIMENSIONS < pas) ? BLOC_DIMENSIONS : pas - debutDim;
+
+            for(b=0; b<tailleLot; b+=4){
+                for(i=0; i<4; i++){ // les lignes manquantes repetent la derniere
+                    x[i] = lot + (size_t)((b+i < tailleLot) ? b+i : tailleLot-1) * pas + debutDim;
+                }
+
+                for(n=debutNeurone; n<finNeurone; n+=4){
+                    for(j=0; j<4; j++){
+                        w[j] = dataMatrice.poids + (size_t)((n+j < finNeurone) ? n+j : finNeurone-1) * pas + debutDim;
+                    }
+
+                    dataMatrice.noyauProduit(x, w, nbDim, produits);
+
+                    for(i=0; i<4 && b+i<tailleLot; i++){
+                        for(j=0; j<4 && n+j<finNeurone; j++){
+                            resultat[(size_t)(b+i)*nbNeurone + n+j] -= 2.0 * produits[i*4 + j];
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    for(b=0; b<tailleLot; b++){
+        for(n=0; n<nbNeurone; n++){
+            if(resultat[(size_t)b*nbNeurone + n] < 0.0){
+                resultat[(size_t)b*nbNeurone + n] = 0.0;
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief Clips a neighborhood window to the borders of the grid along one axis.
+ *
+ * @param centre The coordinate of the center of the window.
+ * @param voisin The radius of the window.
+ * @param taille The size of the grid along this axis.
+ * @param debut Output: the first coordinate of the window.
+ * @param fin Output: the last coordinate of the window (included).
+ */
+void bornesFenetre(int centre, int voisin, int taille, int * debut, int * fin){
+    *debut = (centre - voisin < 0) ? 0 : centre - voisin;
+    *fin = (centre + voisin >= taille) ? taille - 1 : centre + voisin;
+}
+
+
+/**
+ * @brief Gives the learning rate and the neighborhood radius of an epoch.
+ *
+ * The training consists of two phases:
+ * - **Phase 1:** In the first 20% of the training, the neighborhood radius is reduced
+ *   from 3 to 1 in three equal sub-phases, with the initial learning rate.
+ * - **Phase 2:** In the remaining 80% of the training, the radius stays at 1 and the learning
+ *   rate is divided by 100 to fine-tune the map.
+ *
+ * @param i The index of the epoch.
+ * @param temps The total number of epochs.
+ * @param alphaDepart The initial learning rate.
+ * @param alpha Output: the learning rate of the epoch.
+ * @param voisin Output: the neighborhood radius of the epoch.
+ */
+void planningApprentissage(int i, int temps, double alphaDepart, double * alpha, int * voisin){
+
+    if(i < ( (1.0/5.0) * temps ) ){  //phase 1
+        *alpha = alphaDepart;
+
+        if(i < (1.0/5.0) * temps /3 ){ // sous phase 1
+            *voisin = RAYON_VOISINAGE_MAX;
+        }
+        else if(i < 2* ( (1.0/5.0) * temps  /3 ) ){ // sous phase 2
+            *voisin = 2;
+        }
+        else{ //sous phase 3
+            *voisin = 1;
+        }
+    }
+
+    else{ // phase 2
+        *alpha = alphaDepart/100;
+        *voisin = 1;
+    }
+}
+
+
+/**
+ * @brief Creates the state of the local BMU search.
+ *
+ * Every neuron is marked as moved, so all the bounds are computed at the first refresh.
+ *
+ * @param rayon The radius of the searched window.
+ * @param nbDonnees The number of data points.
+ * @param nbNeurone The number of neurons.
+ * @param tailleVecPad The row stride of the codebook.
+ * @return The new state, to be released with `libererRechercheLocale`.
+ */
+RechercheLocale creerRechercheLocale(int rayon, int nbDonnees, int nbNeurone, int tailleVecPad){
+    RechercheLocale locale;
+    int k;
+
+    locale.rayon = rayon;
+    locale.derniersBMU = malloc(nbDonnees * sizeof(int));
+    locale.rayonSur = malloc(nbNeurone * sizeof(double));
+    locale.suivi.reference = allocAligne((size_t)nbNeurone * tailleVecPad * sizeof(reel));
+    locale.suivi.derive = malloc(nbNeurone * sizeof(double));
+    locale.suivi.deriveMax = HUGE_VAL;
+    locale.nbRecherches = 0;
+    locale.nbReplis = 0;
+    locale.nbDistances = 0;
+
+    for(k=0; k<nbNeurone; k++){
+        locale.suivi.derive[k] = HUGE_VAL;
+    }
+
+    for(k=0; k<nbDonnees; k++){
+        locale.derniersBMU[k] = -1;
+    }
+
+    return locale;
+}
+
+
+/**
+ * @brief Updates the bounds of the local search for the neurons that moved.
+ *
+ * The bound of a moved neuron is recomputed from its distances to every neuron outside its
+ * window. The bound of a neuron that did not move only takes the minimum with its new distances
+ * to the moved neurons: the distances to the neurons that did not move are unchanged, so it stays
+ * a lower bound, possibly below the exact distance if its nearest outside neuron moved away.
+ * The moved neurons are copied to the reference codebook and their drift is reset.
+ *
+ * @param locale The state of the local search.
+ * @param dataMatrice The neuron matrix.
+ */
+void rafraichirRechercheLocale(RechercheLocale * locale, ParamMatrice dataMatrice){
+    int p, n, nb = dataMatrice.nbNeurone;
+    double distance;
+    double * derive = locale->suivi.derive;
+
+    for(p=0; p<nb; p++){
+        if(derive[p] != 0.0){
+            locale->rayonSur[p] = HUGE_VAL;
+        }
+    }
+
+    for(p=0; p<nb; p++){
+        if(derive[p] == 0.0){
+            continue;
+        }
+
+        for(n=0; n<nb; n++){
+            if(n < p && derive[n] != 0.0){ // deja calcule avec la ligne n
+                continue;
+            }
+
+            if(abs(n / dataMatrice.longueur - p / dataMatrice.longueur) <= locale->rayon
+               && abs(n % dataMatrice.longueur - p % dataMatrice.longueur) <= locale->rayon){
+                continue;
+            }
+
+            distance = sqrt(dataMatrice.noyauDistance(dataMatrice.poids + (size_t)p * dataMatrice.tailleVecPad,
+                                                      dataMatrice.poids + (size_t)n * dataMatrice.tailleVecPad, dataMatrice.tailleVec));
+            locale->nbDistances++;
+
+            if(distance < locale->rayonSur[p]){
+                locale->rayonSur[p] = distance;
+            }
+
+            if(distance < locale->rayonSur[n]){ // la fenetre est symetrique : p est aussi hors de celle de n
+                locale->rayonSur[n] = distance;
+            }
+        }
+    }
+
+    for(p=0; p<nb; p++){
+        if(derive[p] != 0.0){
+            memcpy(locale->suivi.reference + (size_t)p * dataMatrice.tailleVecPad,
+                   dataMatrice.poids + (size_t)p * dataMatrice.tailleVecPad, dataMatrice.tailleVecPad * sizeof(reel));
+            derive[p] = 0.0;
+        }
+    }
+
+    locale->suivi.deriveMax = 0.0;
+}
+
+
+/**
+ * @brief Finds the BMU of a data point, searching first around its previous BMU.
+ *
+ * The result is the same as `distanceEuclidienneMatrice` followed by `rechercheBMU`: the full
+ * scan runs for the first search of a data point and whenever the bound of `RechercheLocale`
+ * does not prove the local minimum to be global. The second best neuron is not computed by
+ * the local search (`indiceSecond` is -1).
+ *
+ * @param locale The state of the local search.
+ * @param dataMatrice The neuron matrix.
+ * @param donnee The index of the data point.
+ * @param vecteur The vector of the data point.
+ * @return The BMU.
+ */
+BMU rechercheBMULocale(RechercheLocale * locale, ParamMatrice dataMatrice, int donnee, reel * vecteur){
+    int p = locale->derniersBMU[donnee];
+    int i, j, k, debutX, finX, debutY, finY;
+    double distance, distancePrecedent = 0.0;
+    BMU bmu;
+
+    locale->nbRecherches++;
+
+    if(p >= 0){
+        bornesFenetre(p / dataMatrice.longueur, locale->rayon, dataMatrice.largeur, &debutX, &finX);
+        bornesFenetre(p % dataMatrice.longueur, locale->rayon, dataMatrice.longueur, &debutY, &finY);
+        bmu.distance = HUGE_VAL;
+        bmu.nbEgalites = 0;
+
+        for(i=debutX; i<=finX; i++){
+            for(j=debutY; j<=finY; j++){
+                k = i*dataMatrice.longueur + j;
+                distance = dataMatrice.noyauDistance(vecteur, dataMatrice.poids + (size_t)k * dataMatrice.tailleVecPad, dataMatrice.tailleVec);
+
+                if(k == p){
+                    distancePrecedent = distance;
+                }
+
+                if(distance < bmu.distance){
+                    bmu.indice = k;
+                    bmu.distance = distance;
+                    bmu.nbEgalites = 1;
+                }
+                else if(distance == bmu.distance && tirerBorne(dataMatrice.generateur, ++bmu.nbEgalites) == 0){ // tirage uniforme parmi les ex aequo
+                    bmu.indice = k;
+                }
+            }
+        }
+
+        locale->nbDistances += (long)(finX - debutX + 1) * (finY - debutY + 1);
+
+        if(dataMatrice.mesure != NULL){
+            dataMatrice.mesure->compteurs.nbDistances += (long)(finX - debutX + 1) * (finY - debutY + 1);
+        }
+
+        if(sqrt(bmu.distance) < locale->rayonSur[p] - locale->suivi.derive[p] - locale->suivi.deriveMax - sqrt(distancePrecedent)){
+            if(dataMatrice.mesure != NULL){ // sinon comptee par trouverBMU
+                dataMatrice.mesure->compteurs.nbRecherches++;
+                dataMatrice.mesure->compteurs.nbEgalites += bmu.nbEgalites > 1;
+            }
+
+            bmu.x = bmu.indice / dataMatrice.longueur;
+            bmu.y = bmu.indice % dataMatrice.longueur;
+            bmu.indiceSecond = -1;
+            bmu.distanceSecond = HUGE_VAL;
+            locale->derniersBMU[donnee] = bmu.indice;
+
+            return bmu;
+        }
+
+        locale->nbReplis++;
+    }
+
+    bmu = trouverBMU(dataMatrice, vecteur, dataMatrice.generateur);
+    locale->nbDistances += dataMatrice.nbNeurone;
+    locale->derniersBMU[donnee] = bmu.indice;
+
+    return bmu;
+}
+
+
+/**
+ * @brief Releases the state of the local BMU search.
+ *
+ * @param locale The state of the local search.
+ */
+void libererRechercheLocale(RechercheLocale locale){
+    free(locale.derniersBMU);
+    free(locale.rayonSur);
+    libererAligne(locale.suivi.reference);
+    free(locale.suivi.derive);
+}
+
+
+/**
+ * @brief Creates the state of the BMU search pruned by the triangle inequality.
+ *
+ * Every neuron is marked as moved, so all the lists are computed at the first refresh. The
+ * lists take at most `TAILLE_MAX_ELAGAGE` bytes: every other neuron for the maps that fit,
+ * the nearest neighbors that fit for the larger ones.
+ *
+ * @param nbDonnees The number of data points.
+ * @param nbNeurone The number of neurons.
+ * @param tailleVecPad The row stride of the codebook.
+ * @return The new state, to be released with `libererElagage`, with NULL `voisins` (and nothing
+ *         allocated) if the lists cannot be allocated.
+ */
+ElagageTriangulaire creerElagage(int nbDonnees, int nbNeurone, int tailleVecPad){
+    ElagageTriangulaire elagage;
+    size_t capacite = TAILLE_MAX_ELAGAGE / ((size_t)nbNeurone * (sizeof(int) + sizeof(float)));
+    int k;
+
+    memset(&elagage, 0, sizeof(elagage));
+    elagage.nbVoisinsMax = (capacite < (size_t)nbNeurone - 1) ? (int)capacite : nbNeurone - 1;
+
+    if(elagage.nbVoisinsMax < 1){
+        elagage.nbVoisinsMax = 1;
+    }
+
+    elagage.voisins = malloc((size_t)nbNeurone * elagage.nbVoisinsMax * sizeof(int));
+    elagage.distancesVoisins = malloc((size_t)nbNeurone * elagage.nbVoisinsMax * sizeof(float));
+
+    if(elagage.voisins == NULL || elagage.distancesVoisins == NULL){
+        free(elagage.voisins);
+        free(elagage.distancesVoisins);
+        elagage.voisins = NULL;
+        return elagage;
+    }
+
+    elagage.nbVoisins = calloc(nbNeurone, sizeof(int));
+    elagage.rayonReste = malloc(nbNeurone * sizeof(float));
+    elagage.marques = calloc(nbNeurone, sizeof(char));
+    elagage.suivi.reference = allocAligne((size_t)nbNeurone * tailleVecPad * sizeof(reel));
+    elagage.suivi.derive = malloc(nbNeurone * sizeof(double));
+    elagage.suivi.deriveMax = HUGE_VAL;
+    elagage.derniersBMU = malloc(nbDonnees * sizeof(int));
+    elagage.nbCandidats = 0;
+    elagage.nbElagues = 0;
+    elagage.nbLignes = 0;
+
+    for(k=0; k<nbNeurone; k++){
+        elagage.suivi.derive[k] = HUGE_VAL;
+    }
+
+    for(k=0; k<nbDonnees; k++){
+        elagage.derniersBMU[k] = -1;
+    }
+
+    return elagage;
+}
+
+
+/**
+ * @brief Moves an entry of a neighbor list down its max-heap.
+ *
+ * @param voisins The neighbors of the list.
+ * @param distances Their distances.
+ * @param nb The number of entries of the list.
+ * @param p The position of the entry to move down.
+ */
+void descendreVoisin(int * voisins, float * distances, int nb, int p){
+    int voisin = voisins[p], fils;
+    float distance = distances[p];
+
+    while((fils = 2*p+1) < nb){
+        if(fils+1 < nb && distances[fils+1] > distances[fils]){
+            fils++;
+        }
+
+        if(distances[fils] <= distance){
+            break;
+        }
+
+        voisins[p] = voisins[fils];
+        distances[p] = distances[fils];
+        p = fils;
+    }
+
+    voisins[p] = voisin;
+    distances[p] = distance;
+}
+
+
+/**
+ * @brief Offers a neighbor, absent from the list, to the list of a neuron.
+ *
+ * A list that is not full takes the neighbor; it becomes a max-heap when it fills up. A full
+ * list keeps the nearer of the neighbor and its farthest entry, and the bound of the neurons
+ * missing from the list takes the distance of the one left out.
+ *
+ * @param elagage The state of the pruned search.
+ * @param neurone The neuron whose list is updated.
+ * @param voisin The offered neighbor.
+ * @param borne The distance between the two neurons, rounded down.
+ */
+void proposerVoisin(ElagageTriangulaire * elagage, int neurone, int voisin, float borne){
+    int k = elagage->nbVoisinsMax, p;
+    int * voisins = elagage->voisins + (size_t)neurone * k;
+    float * distances = elagage->distancesVoisins + (size_t)neurone * k;
+    float * reste = elagage->rayonReste + neurone;
+
+    if(elagage->nbVoisins[neurone] < k){
+        voisins[elagage->nbVoisins[neurone]] = voisin;
+        distances[elagage->nbVoisins[neurone]] = borne;
+
+        if(++elagage->nbVoisins[neurone] == k){
+            for(p=k/2-1; p>=0; p--){
+                descendreVoisin(voisins, distances, k, p);
+            }
+        }
+    }
+    else if(borne < distances[0]){ // la racine sort de la liste
+        if(distances[0] < *reste){
+            *reste = distances[0];
+        }
+
+        voisins[0] = voisin;
+        distances[0] = borne;
+        descendreVoisin(voisins, distances, k, 0);
+    }
+    else if(borne < *reste){
+        *reste = borne;
+    }
+}
+
+
+/**
+ * @brief Recomputes the neighbor lists for the neurons that moved.
+ *
+ * The lists of the moved neurons are emptied and the moved neurons are removed from the other
+ * lists; every pair involving a moved neuron is then measured and offered to both lists
+ * (`proposerVoisin`). The distances between two neurons that did not move are still exact and
+ * are kept. The moved neurons are copied to the reference codebook and their drift is reset.
+ * Each distance is stored rounded down to a float, so the lists only hold lower bounds.
+ *
+ * @param elagage The state of the pruned search.
+ * @param dataMatrice The neuron matrix.
+ */
+void rafraichirElagage(ElagageTriangulaire * elagage, ParamMatrice dataMatrice){
+    int k, j, v, nb, n = dataMatrice.nbNeurone;
+    int * voisins;
+    float * distances;
+    double distance;
+    float borne;
+    double * derive = elagage->suivi.derive;
+
+    elagage->nbLignes = 0;
+
+    for(k=0; k<n; k++){
+        if(derive[k] != 0.0){
+            elagage->nbVoisins[k] = 0;
+            elagage->rayonReste[k] = HUGE_VALF;
+            continue;
+        }
+
+        voisins = elagage->voisins + (size_t)k * elagage->nbVoisinsMax;
+        distances = elagage->distancesVoisins + (size_t)k * elagage->nbVoisinsMax;
+
+        for(v=0, nb=0; v<elagage->nbVoisins[k]; v++){ // les voisins deplaces seront reproposes
+            if(derive[voisins[v]] == 0.0){
+                voisins[nb] = voisins[v];
+                distances[nb++] = distances[v];
+            }
+        }
+
+        elagage->nbVoisins[k] = nb;
+    }
+
+    for(k=0; k<n; k++){
+        if(derive[k] == 0.0){
+            continue;
+        }
+
+        for(j=0; j<n; j++){
+            if(j == k || (j < k && derive[j] != 0.0)){ // deja calcule avec la liste j
+                continue;
+            }
+
+            distance = sqrt(dataMatrice.noyauDistance(dataMatrice.poids + (size_t)k * dataMatrice.tailleVecPad,
+                                                      dataMatrice.poids + (size_t)j * dataMatrice.tailleVecPad, dataMatrice.tailleVec));
+            borne = (float)distance;
+
+            if((double)borne > distance){
+                borne = nextafterf(borne, 0.0f);
+            }
+
+            proposerVoisin(elagage, k, j, borne);
+            proposerVoisin(elagage, j, k, borne);
+        }
+
+        elagage->nbLignes++;
+    }
+
+    for(k=0; k<n; k++){
+        if(derive[k] != 0.0){
+            memcpy(elagage->suivi.reference + (size_t)k * dataMatrice.tailleVecPad,
+                   dataMatrice.poids + (size_t)k * dataMatrice.tailleVecPad, dataMatrice.tailleVecPad * sizeof(reel));
+            derive[k] = 0.0;
+        }
+    }
+
+    elagage->suivi.deriveMax = 0.0;
+}
+
+
+/**
+ * @brief Finds the BMU of a data point, skipping the neurons the triangle inequality rules out.
+ *
+ * The search starts from the previous BMU d of the data point and uses its list. A neuron j is
+ * pruned when the lower bound of ||w_d - w_j||, stored value minus the drifts of d and j, is
+ * strictly above ||x - w_d|| + ||x - w_b||, b the best neuron so far: j is then strictly farther
+ * from x than b. The neurons missing from the list are pruned all at once when the bound of the
+ * rest allows it with the largest drift, and one by one otherwise. The BMU is the one of the full
+ * scan; ties are broken as in `rechercheBMU`. The second best neuron is not computed
+ * (`indiceSecond` is -1).
+ *
+ * @param elagage The state of the pruned search.
+ * @param dataMatrice The neuron matrix.
+ * @param donnee The index of the data point.
+ * @param vecteur The vector of the data point.
+ * @return The BMU.
+ */
+BMU rechercheBMUElagage(ElagageTriangulaire * elagage, ParamMatrice dataMatrice, int donnee, reel * vecteur){
+    int j, v, depart = (elagage->derniersBMU[donnee] >= 0) ? elagage->derniersBMU[donnee] : 0;
+    int n = dataMatrice.nbNeurone, nb = elagage->nbVoisins[depart];
+    double rayonDepart, rayonElagage, deriveDepart, reste;
+    const int * voisins = elagage->voisins + (size_t)depart * elagage->nbVoisinsMax;
+    const float * distances = elagage->distancesVoisins + (size_t)depart * elagage->nbVoisinsMax;
+    const double * derive = elagage->suivi.derive;
+    long dejaElagues = elagage->nbElagues;
+    BMU bmu;
+
+    bmu.indice = depart;
+    bmu.distance = dataMatrice.noyauDistance(vecteur, dataMatrice.poids + (size_t)depart * dataMatrice.tailleVecPad, dataMatrice.tailleVec);
+    bmu.indiceSecond = -1;
+    bmu.distanceSecond = HUGE_VAL;
+    bmu.nbEgalites = 1;
+    rayonDepart = sqrt(bmu.distance);
+    rayonElagage = 2.0 * rayonDepart;
+    deriveDepart = derive[depart];
+
+    for(v=0; v<nb; v++){
+        j = voisins[v];
+
+        if((double)distances[v] - deriveDepart - derive[j] > rayonElagage){
+            elagage->nbElagues++;
+            continue;
+        }
+
+        comparerBMU(&bmu, j, dataMatrice.noyauDistance(vecteur, dataMatrice.poids + (size_t)j * dataMatrice.tailleVecPad, dataMatrice.tailleVec), dataMatrice.generateur);
+
+        if(bmu.indice == j && bmu.nbEgalites == 1){ // nouveau meilleur : le rayon se resserre
+            rayonElagage = rayonDepart + sqrt(bmu.distance);
+        }
+    }
+
+    if(nb < n-1){ // neurones absents de la liste
+        reste = (double)elagage->rayonReste[depart] - deriveDepart;
+
+        if(reste - elagage->suivi.deriveMax > rayonElagage){
+            elagage->nbElagues += n-1 - nb;
+        }
+        else{
+            elagage->marques[depart] = 1;
+
+            for(v=0; v<nb; v++){
+                elagage->marques[voisins[v]] = 1;
+            }
+
+            for(j=0; j<n; j++){
+                if(elagage->marques[j]){
+                    continue;
+                }
+
+                if(reste - derive[j] > rayonElagage){
+                    elagage->nbElagues++;
+                    continue;
+                }
+
+                comparerBMU(&bmu, j, dataMatrice.noyauDistance(vecteur, dataMatrice.poids + (size_t)j * dataMatrice.tailleVecPad, dataMatrice.tailleVec), dataMatrice.generateur);
+
+                if(bmu.indice == j && bmu.nbEgalites == 1){
+                    rayonElagage = rayonDepart + sqrt(bmu.distance);
+                }
+            }
+
+            elagage->marques[depart] = 0;
+
+            for(v=0; v<nb; v++){
+                elagage->marques[voisins[v]] = 0;
+            }
+        }
+    }
+
+    elagage->nbCandidats += n;
+    elagage->derniersBMU[donnee] = bmu.indice;
+
+    if(dataMatrice.mesure != NULL){
+        dataMatrice.mesure->compteurs.nbRecherches++;
+        dataMatrice.mesure->compteurs.nbDistances += n - (elagage->nbElagues - dejaElagues);
+        dataMatrice.mesure->compteurs.nbEgalites += bmu.nbEgalites > 1;
+    }
+    bmu.indiceSecond = -1;
+    bmu.distanceSecond = HUGE_VAL;
+    bmu.x = bmu.indice / dataMatrice.longueur;
+    bmu.y = bmu.indice % dataMatrice.longueur;
+
+    return bmu;
+}
+
+
+/**
+ * @brief Releases the state of the pruned BMU search.
+ *
+ * @param elagage The state of the pruned search.
+ */
+void libererElagage(ElagageTriangulaire elagage){
+    free(elagage.voisins);
+    free(elagage.distancesVoisins);
+    free(elagage.nbVoisins);
+    free(elagage.rayonReste);
+    free(elagage.marques);
+    libererAligne(elagage.suivi.reference);
+    free(elagage.suivi.derive);
+    free(elagage.derniersBMU);
+}
+
+
+/**
+ * @brief Projects a vector to the sketch space.
+ *
+ * @param esquisse The state of the two-stage search (projection matrix).
+ * @param vecteur The vector to project.
+ * @param tailleVec The dimension of the vector.
+ * @param sortie The sketch (`esquisse->dimension` values).
+ */
+void projeterEsquisse(const Esquisse * esquisse, const reel * vecteur, int tailleVec, reel * sortie){
+    int r, k;
+    double somme;
+    const float * ligne = esquisse->projection;
+
+    for(r=0; r<esquisse->dimension; r++){
+        somme = 0.0;
+
+        for(k=0; k<tailleVec; k++){
+            somme += ligne[k] * vecteur[k];
+        }
+
+        sortie[r] = somme;
+        ligne += tailleVec;
+    }
+}
+
+
+/**
+ * @brief Creates the state of the two-stage BMU search and sketches the dataset.
+ *
+ * The entries of the projection are +-1/sqrt(dimension) with equal probability, drawn with
+ * a generator with a fixed seed, so the projection does not depend on the rest of the run and
+ * the squared distances are preserved on average. The neurons are sketched by `rafraichirEsquisse`.
+ *
+ * @param data The dataset.
+ * @param dimension The dimension of the sketches.
+ * @param nbCandidats The number of candidates rescored at full dimension (clipped to the map).
+ * @param nbNeurone The number of neurons.
+ * @return The new state, to be released with `libererEsquisse`.
+ */
+Esquisse creerEsquisse(paramDataset data, int dimension, int nbCandidats, int nbNeurone){
+    Esquisse esquisse;
+    int k;
+    Generateur generateur = creerGenerateur(GRAINE_ESQUISSE);
+    float echelle = (float)(1.0 / sqrt((double)dimension));
+
+    esquisse.dimension = dimension;
+    esquisse.nbCandidats = (nbCandidats < nbNeurone) ? nbCandidats : nbNeurone;
+    esquisse.projection = malloc((size_t)dimension * data.tailleVec * sizeof(float));
+    esquisse.esquissesNeurones = malloc((size_t)nbNeurone * dimension * sizeof(reel));
+    esquisse.esquissesDonnees = malloc((size_t)data.tailleTab * dimension * sizeof(reel));
+    esquisse.courante = NULL;
+    esquisse.candidats = malloc(esquisse.nbCandidats * sizeof(int));
+    esquisse.distancesCandidats = malloc(esquisse.nbCandidats * sizeof(double));
+    esquisse.nbControles = 0;
+    esquisse.nbExacts = 0;
+
+    for(k=0; k<dimension*data.tailleVec; k++){
+        esquisse.projection[k] = (tirerGenerateur(&generateur) >> 63) ? echelle : -echelle;
+    }
+
+    for(k=0; k<data.tailleTab; k++){
+        projeterEsquisse(&esquisse, data.mesDataset[k].vecteur, data.tailleVec, esquisse.esquissesDonnees + (size_t)k * dimension);
+    }
+
+    return esquisse;
+}
+
+
+/**
+ * @brief Recomputes the sketches of all the neurons from their weights.
+ *
+ * Called at the start of every epoch, so the rounding of the incremental updates done by
+ * `apprentissage` does not accumulate.
+ *
+ * @param esquisse The state of the two-stage search.
+ * @param dataMatrice The neuron matrix.
+ */
+void rafraichirEsquisse(Esquisse * esquisse, ParamMatrice dataMatrice){
+    int k;
+
+    for(k=0; k<dataMatrice.nbNeurone; k++){
+        projeterEsquisse(esquisse, dataMatrice.poids + (size_t)k * dataMatrice.tailleVecPad, dataMatrice.tailleVec,
+                         esquisse->esquissesNeurones + (size_t)k * esquisse->dimension);
+    }
+}
+
+
+/**
+ * @brief Finds the BMU of a data point among the neurons nearest to it in the sketch space.
+ *
+ * The sketch distances are computed with the distance kernel of the matrix. The `nbCandidats`
+ * neurons of smallest sketch distance are kept in a max-heap, then rescored
+ * with the full distance kernel; ties among them are broken as in `rechercheBMU`. The result
+ * is approximate. One data point out of `PAS_CONTROLE_ESQUISSE` is also checked against the
+ * exact scan, to measure the recall.
+ *
+ * @param esquisse The state of the two-stage search.
+ * @param dataMatrice The neuron matrix.
+ * @param donnee The index of the data point.
+ * @param vecteur The vector of the data point.
+ * @return The BMU (the second best neuron is the second best candidate).
+ */
+BMU rechercheBMUEsquisse(Esquisse * esquisse, ParamMatrice dataMatrice, int donnee, reel * vecteur){
+    int j, p, fils, nbTas = 0;
+    int m = esquisse->dimension, k = esquisse->nbCandidats;
+    int * tas = esquisse->candidats;
+    double * cles = esquisse->distancesCandidats;
+    reel * cible = esquisse->esquissesDonnees + (size_t)donnee * m;
+    reel * neurone = esquisse->esquissesNeurones;
+    double distance, exacte, minimum;
+    BMU bmu;
+
+    for(j=0; j<dataMatrice.nbNeurone; j++, neurone+=m){
+        distance = dataMatrice.noyauDistance(cible, neurone, m);
+
+        if(nbTas < k){ // insertion par le bas du tas
+            p = nbTas++;
+
+            while(p > 0 && cles[(p-1)/2] < distance){
+                tas[p] = tas[(p-1)/2];
+                cles[p] = cles[(p-1)/2];
+                p = (p-1)/2;
+            }
+        }
+        else if(distance < cles[0]){ // remplacement de la racine
+            p = 0;
+
+            while((fils = 2*p+1) < k){
+                if(fils+1 < k && cles[fils+1] > cles[fils]){
+                    fils++;
+                }
+
+                if(cles[fils] <= distance){
+                    break;
+                }
+
+                tas[p] = tas[fils];
+                cles[p] = cles[fils];
+                p = fils;
+            }
+        }
+        else{
+            continue;
+        }
+
+        tas[p] = j;
+        cles[p] = distance;
+    }
+
+    bmu.indice = -1;
+    bmu.distance = HUGE_VAL;
+    bmu.indiceSecond = -1;
+    bmu.distanceSecond = HUGE_VAL;
+    bmu.nbEgalites = 0;
+
+    for(p=0; p<nbTas; p++){
+        comparerBMU(&bmu, tas[p], dataMatrice.noyauDistance(vecteur, dataMatrice.poids + (size_t)tas[p] * dataMatrice.tailleVecPad, dataMatrice.tailleVec), dataMatrice.generateur);
+    }
+
+    if(donnee % PAS_CONTROLE_ESQUISSE == 0){ // controle du rappel par le parcours exact
+        minimum = HUGE_VAL;
+
+        for(j=0; j<dataMatrice.nbNeurone; j++){
+            exacte = dataMatrice.noyauDistance(vecteur, dataMatrice.poids + (size_t)j * dataMatrice.tailleVecPad, dataMatrice.tailleVec);
+
+            if(exacte < minimum){
+                minimum = exacte;
+            }
+        }
+
+        esquisse->nbControles++;
+        esquisse->nbExacts += (bmu.distance <= minimum);
+
+        if(dataMatrice.mesure != NULL){
+            dataMatrice.mesure->compteurs.nbDistances += dataMatrice.nbNeurone;
+        }
+    }
+
+    if(dataMatrice.mesure != NULL){ // distances en pleine dimension
+        dataMatrice.mesure->compteurs.nbRecherches++;
+        dataMatrice.mesure->compteurs.nbDistances += nbTas;
+        dataMatrice.mesure->compteurs.nbEgalites += bmu.nbEgalites > 1;
+    }
+
+    bmu.x = bmu.indice / dataMatrice.longueur;
+    bmu.y = bmu.indice % dataMatrice.longueur;
+
+    return bmu;
+}
+
+
+/**
+ * @brief Releases the state of the two-stage BMU search.
+ *
+ * @param esquisse The state of the two-stage search.
+ */
+void libererEsquisse(Esquisse esquisse){
+    free(esquisse.projection);
+    free(esquisse.esquissesNeurones);
+    free(esquisse.esquissesDonnees);
+    free(esquisse.candidats);
+    free(esquisse.distancesCandidats);
+}
+
+
+/**
+ * @brief Performs the training process using the Self-Organizing Map (SOM) algorithm.
+ *
+ * This function simulates the learning process of the Self-Organizing Map (SOM) algorithm, where 
+ * a dataset is progressively mapped to a matrix of neurons. The function adjusts the neurons' weights 
+ * based on the Euclidean distance between the dataset vectors and the neurons in the matrix.
+ * The learning rate (`alpha`) and the neighborhood size (`nbVoisin`) of each epoch are given by
+ * `planningApprentissage`.
+ *
+ * The function selects the Best Matching Unit (BMU) for each data point and performs learning based on the 
+ * BMU’s position in the matrix (online rule: one update per data point).
+ *
+ * The data points are visited in a new random order at every epoch (`tabMelanger`, reshuffled with the
+ * `generateur` of the matrix, which also breaks the ties of the BMU searches).
+ *
+ * With a mini-batch size above 1, the distances of `tailleLot` consecutive data points are computed
+ * together by `distancesLot`. The data points are still processed one after the other: after each
+ * update, the distances of the remaining data points of the batch to the neurons of the updated window
+ * are recomputed, so every BMU is found on the current codebook, as with the one-at-a-time path.
+ *
+ * With a local search radius above 0, the one-at-a-time path finds each BMU with
+ * `rechercheBMULocale`; the bounds are refreshed at the start of every epoch and the share of
+ * full scans and the number of distances per search are printed at the end. Otherwise, with
+ * `triangle` set, it uses `rechercheBMUElagage` and prints the share of pruned neurons of every epoch.
+ * Otherwise, with a sketch dimension, it uses the approximate `rechercheBMUEsquisse` and prints
+ * its measured recall for every epoch.
+ *
+ * @param data A `paramDataset` structure containing the dataset to be mapped to the neuron matrix.
+ * @param dataMatrice A `ParamMatrice` structure containing the matrix of neurons to be updated.
+ * @param alpha The initial learning rate (alpha).
+ * @param temps The number of iterations for training.
+ * @param tailleLot The mini-batch size of the distance computation (1 = one data point at a time).
+ * @param rayonLocal The radius of the local BMU search (0 = full scan; ignored for mini-batches).
+ * @param triangle 1 to prune the BMU search with the triangle inequality (ignored for mini-batches).
+ * @param dimensionEsquisse The dimension of the sketches of the two-stage BMU search (0 = off; ignored for mini-batches).
+ * @param nbCandidats The number of candidates of the two-stage search rescored at full dimension.
+ */
+void rapprochement(paramDataset data, ParamMatrice dataMatrice, double alpha, int temps, int tailleLot, int rayonLocal, int triangle,
+                   int dimensionEsquisse, int nbCandidats){
+    int i,j, index, b, suivant, x, y, nbLot;
+    int debutX, finX, debutY, finY;
+    BMU bmu;
+    double alphaDepart = alpha;
+    reel * lot = NULL;
+    double * normesLot = NULL;
+    double * distancesDuLot = NULL;
+    double * distancesMatrice = dataMatrice.distances;
+    RechercheLocale locale;
+    ElagageTriangulaire elagage;
+    int avecLocale = rayonLocal > 0 && tailleLot <= 1;
+    int avecElagage = triangle && tailleLot <= 1 && !avecLocale;
+    Esquisse esquisse;
+    int avecEsquisse = dimensionEsquisse > 0 && tailleLot <= 1 && !avecLocale && !avecElagage;
+    double debutEpoque;
+
+    if(avecLocale){
+        locale = creerRechercheLocale(rayonLocal, data.tailleTab, dataMatrice.nbNeurone, dataMatrice.tailleVecPad);
+        dataMatrice.suivi = &locale.suivi;
+    }
+
+    if(avecElagage){
+        elagage = creerElagage(data.tailleTab, dataMatrice.nbNeurone, dataMatrice.tailleVecPad);
+        dataMatrice.suivi = &elagage.suivi;
+
+        if(elagage.voisins == NULL){
+            printf("--triangle : memoire insuffisante pour les listes de %d voisins, recherche complete\n", elagage.nbVoisinsMax);
+            dataMatrice.suivi = NULL;
+            avecElagage = 0;
+        }
+    }
+
+    if(avecEsquisse){
+        esquisse = creerEsquisse(data, dimensionEsquisse, nbCandidats, dataMatrice.nbNeurone);
+        dataMatrice.esquisse = &esquisse;
+    }
+
+    if(tailleLot > 1){
+        lot = allocAligne((size_t)tailleLot * dataMatrice.tailleVecPad * sizeof(reel));
+        normesLot = malloc(tailleLot * sizeof(double));
+        distancesDuLot = allocAligne((size_t)tailleLot * dataMatrice.nbNeurone * sizeof(double));
+    }
+
+    for(i=0; i<temps; i++){
+        debutEpoque = chronometre();
+        planningApprentissage(i, temps, alphaDepart, &alpha, &dataMatrice.nbVoisin);
+        melangerIndices(data.tabMelanger, data.tailleTab, dataMatrice.generateur);
+
+        if(tailleLot <= 1){
+            if(avecLocale){
+                rafraichirRechercheLocale(&locale, dataMatrice);
+            }
+
+            if(avecElagage){
+                rafraichirElagage(&elagage, dataMatrice);
+                elagage.nbCandidats = 0;
+                elagage.nbElagues = 0;
+            }
+
+            if(avecEsquisse){
+                rafraichirEsquisse(&esquisse, dataMatrice);
+                esquisse.nbControles = 0;
+                esquisse.nbExacts = 0;
+            }
+
+            for(j=0; j<data.tailleTab; j++){
+                index = data.tabMelanger[j];
+
+                if(avecLocale){
+                    bmu = rechercheBMULocale(&locale, dataMatrice, index, data.mesDataset[index].vecteur);
+                }
+                else if(avecElagage){
+                    bmu = rechercheBMUElagage(&elagage, dataMatrice, index, data.mesDataset[index].vecteur);
+                }
+                else if(avecEsquisse){
+                    bmu = rechercheBMUEsquisse(&esquisse, dataMatrice, index, data.mesDataset[index].vecteur);
+                    esquisse.courante = esquisse.esquissesDonnees + (size_t)index * esquisse.dimension;
+                }
+                else{
+                    bmu = trouverBMU(dataMatrice, data.mesDataset[index].vecteur, dataMatrice.generateur);
+                }
+                //printf("BMU choisi %d %d\n", bmu.x, bmu.y);
+
+                // apprentissage
+                apprentissage(bmu, dataMatrice, alpha, data.tailleVec, dataMatrice.nbVoisin, data.mesDataset[index].vecteur);
+            }
+
+            if(avecElagage){
+                printf("epoque %d : %.2f %% des neurones elagues, %d liste(s) de voisins recalculee(s)\n", i,
+                       (elagage.nbCandidats > 0) ? 100.0 * elagage.nbElagues / elagage.nbCandidats : 0.0, elagage.nbLignes);
+            }
+
+            if(avecEsquisse){
+                printf("epoque %d : rappel de l'esquisse %.2f %% (%ld recherche(s) controlee(s))\n", i,
+                       (esquisse.nbControles > 0) ? 100.0 * esquisse.nbExacts / esquisse.nbControles : 0.0, esquisse.nbControles);
+            }
+
+            if(dataMatrice.mesure != NULL){
+                noterEpoque(dataMatrice.mesure, chronometre() - debutEpoque);
+            }
+            continue;
+        }
+
+        for(j=0; j<data.tailleTab; j+=tailleLot){
+            nbLot = (j + tailleLot < data.tailleTab) ? tailleLot : data.tailleTab - j;
+            preparerLot(data, data.tabMelanger + j, 0, nbLot, lot, normesLot);
+            distancesLot(lot, normesLot, nbLot, dataMatrice, distancesDuLot);
+
+            for(b=0; b<nbLot; b++){
+                index = data.tabMelanger[j+b];
+                dataMatrice.distances = distancesDuLot + (size_t)b * dataMatrice.nbNeurone;
+                bmu = rechercheBMU(dataMatrice, dataMatrice.generateur);
+                apprentissage(bmu, dataMatrice, alpha, data.tailleVec, dataMatrice.nbVoisin, data.mesDataset[index].vecteur);
+
+                // mise a jour des distances des donnees suivantes pour la fenetre modifiee
+                bornesFenetre(bmu.x, dataMatrice.nbVoisin, dataMatrice.largeur, &debutX, &finX);
+                bornesFenetre(bmu.y, dataMatrice.nbVoisin, dataMatrice.longueur, &debutY, &finY);
+
+                if(dataMatrice.mesure != NULL){
+                    dataMatrice.mesure->compteurs.nbDistances += (long)(nbLot - b - 1) * (finX - debutX + 1) * (finY - debutY + 1);
+                }
+
+                for(suivant=b+1; suivant<nbLot; suivant++){
+                    for(x=debutX; x<=finX; x++){
+                        for(y=debutY; y<=finY; y++){
+                            distancesDuLot[(size_t)suivant * dataMatrice.nbNeurone + x * dataMatrice.longueur + y] =
+                                dataMatrice.noyauDistance(lot + (size_t)suivant * dataMatrice.tailleVecPad, vecteurNeurone(dataMatrice, x, y), data.tailleVec);
+                        }
+                    }
+                }
+            }
+            dataMatrice.distances = distancesMatrice;
+        }
+
+        if(dataMatrice.mesure != NULL){
+            noterEpoque(dataMatrice.mesure, chronometre() - debutEpoque);
+        }
+    }
+
+    if(avecElagage){
+        printf("\n");
+        libererElagage(elagage);
+    }
+
+    if(avecEsquisse){
+        printf("\n");
+        libererEsquisse(esquisse);
+    }
+
+    if(avecLocale){
+        printf("recherche locale (rayon %d) : %.2f %% de parcours complets, %.1f distances par recherche (carte de %d neurones)\n\n",
+               rayonLocal, (locale.nbRecherches > 0) ? 100.0 * locale.nbReplis / locale.nbRecherches : 0.0,
+               (locale.nbRecherches > 0) ? (double)locale.nbDistances / locale.nbRecherches : 0.0, dataMatrice.nbNeurone);
+        libererRechercheLocale(locale);
+    }
+
+    libererAligne(distancesDuLot);
+    free(normesLot);
+    libererAligne(lot);
+}
+
+
+/**
+ * @brief Hogwild training: trains the shard of shuffled data points of one thread.
+ *
+ * @param arg A pointer to the `TacheHogwild` of the thread.
+ * @return NULL.
+ */
+void * hogwildTranche(void * arg){
+    TacheHogwild * tache = arg;
+    int j, index;
+    BMU bmu;
+
+    for(j=tache->debut; j<tache->fin; j++){
+        index = tache->data.tabMelanger[j];
+        bmu = trouverBMU(tache->dataMatrice, tache->data.mesDataset[index].vecteur, &tache->generateur);
+        apprentissage(bmu, tache->dataMatrice, tache->alpha, tache->data.tailleVec, tache->voisin, tache->data.mesDataset[index].vecteur);
+    }
+
+    return NULL;
+}
+
+
+/**
+ * @brief Online training on several threads sharing the codebook without locks (Hogwild).
+ *
+ * At every epoch the data points are reshuffled and the shuffled order is cut into one
+ * contiguous shard per thread. Each thread applies the online rule of `rapprochement` to its
+ * shard: it finds the BMU on the shared codebook and moves the neighborhood with `apprentissage`,
+ * without any lock. A thread may thus read a neuron that another thread is moving, or two threads
+ * may move the same neuron at once and one step is partly lost. These races are tolerated on
+ * purpose: every weight is an aligned `reel`, so a value read is always one that was written,
+ * and the error is bounded by one update step. They are rare when the map is large compared
+ * to the neighborhood, and grow with the number of threads on small maps; `--hogwild-check`
+ * measures their effect on the quantization error.
+ *
+ * Each thread breaks its ties with its own stream, taken `sauterGenerateur` steps after the
+ * generator of the matrix. The BMU accelerators of `rapprochement` (local search, pruning,
+ * sketches, mini-batches) keep state shared between searches and are not used.
+ *
+ * @param data The dataset.
+ * @param dataMatrice The neuron matrix, with its generator.
+ * @param alpha The initial learning rate.
+ * @param temps The number of epochs.
+ * @param nbThreads The number of threads.
+ */
+void entrainementHogwild(paramDataset data, ParamMatrice dataMatrice, double alpha, int temps, int nbThreads){
+    int i, t;
+    double alphaDepart = alpha, debutEpoque;
+    TacheHogwild * taches = malloc(nbThreads * sizeof(TacheHogwild));
+    Generateur flux = *dataMatrice.generateur;
+    Instrumentation * mesures;
+
+    for(t=0; t<nbThreads; t++){
+        sauterGenerateur(&flux);
+        taches[t].data = data;
+        taches[t].dataMatrice = dataMatrice;
+        taches[t].dataMatrice.distances = allocAligne(dataMatrice.nbNeurone * sizeof(double));
+        taches[t].generateur = flux;
+    }
+
+    for(i=0; i<temps; i++){
+        debutEpoque = chronometre();
+        planningApprentissage(i, temps, alphaDepart, &alpha, &dataMatrice.nbVoisin);
+        melangerIndices(data.tabMelanger, data.tailleTab, dataMatrice.generateur);
+        mesures = mesuresThreads(dataMatrice, nbThreads);
+
+        for(t=0; t<nbThreads; t++){ // partage de l'ordre melange
+            taches[t].debut = (int)((long)data.tailleTab * t / nbThreads);
+            taches[t].fin = (int)((long)data.tailleTab * (t+1) / nbThreads);
+            taches[t].alpha = alpha;
+            taches[t].voisin = dataMatrice.nbVoisin;
+            taches[t].dataMatrice.mesure = (mesures != NULL) ? &mesures[t] : NULL;
+        }
+
+        lancerThreads(nbThreads, hogwildTranche, taches, sizeof(TacheHogwild));
+        fusionnerMesures(dataMatrice, mesures, nbThreads);
+
+        if(dataMatrice.mesure != NULL){
+            noterEpoque(dataMatrice.mesure, chronometre() - debutEpoque);
+        }
+    }
+
+    for(t=0; t<nbThreads; t++){
+        libererAligne(taches[t].dataMatrice.distances);
+    }
+    free(taches);
+}
+
+
+/**
+ * @brief Trains a copy of a matrix with the single-threaded online rule, as the reference of `--hogwild-check`.
+ *
+ * The copy starts from the same codebook, shuffled order and generator state as the matrix,
+ * which is left untouched, and uses the plain full-scan rule of `rapprochement`. The copy is
+ * labelled (on `nbThreads` threads) for its errors, then released.
+ *
+ * @param data The dataset, ready for the training.
+ * @param dataMatrice The matrix before its training.
+ * @param param The run configuration.
+ * @param erreurQuantification Receives the quantization error of the reference.
+ * @param erreurTopographique Receives the topographic error of the reference.
+ * @return The training time of the reference, in seconds.
+ */
+double referenceSequentielle(paramDataset data, ParamMatrice dataMatrice, ParamExecution param,
+                             double * erreurQuantification, double * erreurTopographique){
+    ParamMatrice reference;
+    Generateur generateur = *dataMatrice.generateur;
+    int * ordre;
+    double debut, duree;
+
+    memset(&reference, 0, sizeof(reference));
+    reference = genererMatriceNeurone(reference, dataMatrice.nbNeurone, dataMatrice.tailleVec);
+    memcpy(reference.poids, dataMatrice.poids, (size_t)dataMatrice.nbNeurone * dataMatrice.tailleVecPad * sizeof(reel));
+    memcpy(reference.normes, dataMatrice.normes, dataMatrice.nbNeurone * sizeof(double));
+    reference = preparerTableVoisinage(reference, dataMatrice.voisinage, RAYON_VOISINAGE_MAX);
+    reference.abandon = dataMatrice.abandon;
+    reference.generateur = &generateur;
+
+    ordre = data.tabMelanger;
+    data.tabMelanger = malloc(data.tailleTab * sizeof(int));
+    memcpy(data.tabMelanger, ordre, data.tailleTab * sizeof(int));
+
+    debut = chronometre();
+    rapprochement(data, reference, param.alpha, param.temps, 1, 0, 0, 0, param.nbCandidats);
+    duree = chronometre() - debut;
+
+    etiquetageCarte(data, reference, param.nbThreads, param.tailleLot, erreurQuantification, erreurTopographique);
+
+    free(data.tabMelanger);
+    libererMatrice(reference);
+
+    return duree;
+}
+
+
+/**
+ * @brief Batch training, step 1: finds the BMU of a range of data points.
+ *
+ * With a mini-batch size above 1 the distances are computed by blocks with `distancesLot`.
+ * Ties are broken with a generator seeded from `graine` and the index of the data point,
+ * so the result does not depend on which thread handles the data point.
+ *
+ * @param arg A pointer to the `TacheBatch` of the thread (range of data points).
+ * @return NULL.
+ */
+void * batchAffectation(void * arg){
+    TacheBatch * tache = arg;
+    ParamMatrice dataMatrice = tache->dataMatrice;
+    int k, b, nbLot;
+    Generateur generateur;
+    BMU bmu;
+    reel * lot;
+    double * normesLot, * distancesDuLot;
+
+    if(tache->tailleLot <= 1){
+        for(k=tache->debut; k<tache->fin; k++){
+            generateur = creerGenerateur(tache->graine + (uint64_t)k);
+            bmu = trouverBMU(dataMatrice, tache->data.mesDataset[k].vecteur, &generateur);
+            tache->bmus[k] = bmu.indice;
+
+            if(tache->seconds != NULL){
+                tache->seconds[k] = bmu.indiceSecond;
+                tache->distancesBMU[k] = bmu.distance;
+            }
+        }
+
+        return NULL;
+    }
+
+    lot = allocAligne((size_t)tache->tailleLot * dataMatrice.tailleVecPad * sizeof(reel));
+    normesLot = malloc(tache->tailleLot * sizeof(double));
+    distancesDuLot = allocAligne((size_t)tache->tailleLot * dataMatrice.nbNeurone * sizeof(double));
+
+    for(k=tache->debut; k<tache->fin; k+=tache->tailleLot){
+        nbLot = (k + tache->tailleLot < tache->fin) ? tache->tailleLot : tache->fin - k;
+        preparerLot(tache->data, NULL, k, nbLot, lot, normesLot);
+        distancesLot(lot, normesLot, nbLot, dataMatrice, distancesDuLot);
+
+        for(b=0; b<nbLot; b++){
+            generateur = creerGenerateur(tache->graine + (uint64_t)(k+b));
+            dataMatrice.distances = distancesDuLot + (size_t)b * dataMatrice.nbNeurone;
+            bmu = rechercheBMU(dataMatrice, &generateur);
+            tache->bmus[k+b] = bmu.indice;
+
+            if(tache->seconds != NULL){
+                tache->seconds[k+b] = bmu.indiceSecond;
+                tache->distancesBMU[k+b] = bmu.distance;
+            }
+        }
+    }
+
+    libererAligne(distancesDuLot);
+    free(normesLot);
+    libererAligne(lot);
+
+    return NULL;
+}
+
+
+/**
+ * @brief Batch training, step 2: sums the data points won by a range of neurons.
+ *
+ * Each thread owns a range of neurons and reads the BMU array in data order, so every
+ * sum is always accumulated in the same order whatever the number of threads.
+ *
+ * @param arg A pointer to the `TacheBatch` of the thread (range of neurons).
+ * @return NULL.
+ */
+void * batchAccumulation(void * arg){
+    TacheBatch * tache = arg;
+    int k, d, gagnant;
+    double * somme;
+    reel * vecteur;
+
+    memset(tache->sommes + (size_t)tache->debut * tache->dataMatrice.tailleVecPad, 0,
+           (size_t)(tache->fin - tache->debut) * tache->dataMatrice.tailleVecPad * sizeof(double));
+    memset(tache->comptes + tache->debut, 0, (tache->fin - tache->debut) * sizeof(double));
+
+    for(k=0; k<tache->data.tailleTab; k++){
+        gagnant = tache->bmus[k];
+
+        if(gagnant >= tache->debut && gagnant < tache->fin){
+            somme = tache->sommes + (size_t)gagnant * tache->dataMatrice.tailleVecPad;
+            vecteur = tache->data.mesDataset[k].vecteur;
+
+            for(d=0; d<tache->data.tailleVec; d++){
+                somme[d] += vecteur[d];
+            }
+            tache->comptes[gagnant] += 1.0;
+        }
+    }
+
+    return NULL;
+}
+
+
+/**
+ * @brief Batch training, step 3: computes the new weights of a range of neurons.
+ *
+ * The new weight vector of a neuron is the mean of the data points won by the neurons of its
+ * window, weighted by the neighborhood function. A neuron whose window won nothing keeps its weights.
+ *
+ * @param arg A pointer to the `TacheBatch` of the thread (range of neurons).
+ * @return NULL.
+ */
+void * batchMiseAJour(void * arg){
+    TacheBatch * tache = arg;
+    ParamMatrice dataMatrice = tache->dataMatrice;
+    int k, i, j, d, x, y, voisin = tache->voisin;
+    int debutX, finX, debutY, finY;
+    double poidsVoisin, denominateur;
+    double * somme;
+    double * numerateur = malloc(dataMatrice.tailleVec * sizeof(double));
+    reel * vecteur;
+
+    for(k=tache->debut; k<tache->fin; k++){
+        x = k / dataMatrice.longueur;
+        y = k % dataMatrice.longueur;
+        bornesFenetre(x, voisin, dataMatrice.largeur, &debutX, &finX);
+        bornesFenetre(y, voisin, dataMatrice.longueur, &debutY, &finY);
+
+        memset(numerateur, 0, dataMatrice.tailleVec * sizeof(double));
+        denominateur = 0.0;
+
+        for(i=debutX; i<=finX; i++){
+            for(j=debutY; j<=finY; j++){
+
+                if(tache->comptes[i*dataMatrice.longueur + j] == 0.0){
+                    continue;
+                }
+
+                poidsVoisin = coefficientVoisinage(dataMatrice.voisinage, i - x, j - y, voisin);
+                somme = tache->sommes + ((size_t)i * dataMatrice.longueur + j) * dataMatrice.tailleVecPad;
+
+                for(d=0; d<dataMatrice.tailleVec; d++){
+                    numerateur[d] += poidsVoisin * somme[d];
+                }
+                denominateur += poidsVoisin * tache->comptes[i*dataMatrice.longueur + j];
+            }
+        }
+
+        if(denominateur > 0.0){
+            vecteur = dataMatrice.poids + (size_t)k * dataMatrice.tailleVecPad;
+
+            for(d=0; d<dataMatrice.tailleVec; d++){
+                vecteur[d] = numerateur[d] / denominateur;
+            }
+            rafraichirNormes(dataMatrice, k, k+1);
+        }
+    }
+
+    free(numerateur);
+
+    return NULL;
+}
+
+
+/**
+ * @brief Trains the map with the batch SOM rule on several threads.
+ *
+ * Each epoch has three parallel steps separated by a join: the BMU of every data point is
+ * found (data points split between the threads), the data points won by each neuron are summed
+ * (neurons split between the threads, each thread owning the accumulators of its neurons), then
+ * every neuron is replaced by the neighborhood-weighted mean of the data points won by its window.
+ * The neighborhood radius follows `planningApprentissage`; the learning rate is not used.
+ *
+ * Every sum is computed in data order by a single thread, so the trained map is the same
+ * whatever the number of threads.
+ *
+ * @param data The dataset (read only).
+ * @param dataMatrice The neuron matrix to train.
+ * @param temps The number of epochs.
+ * @param nbThreads The number of threads.
+ * @param tailleLot The mini-batch size of the BMU assignment (1 = one data point at a time).
+ */
+void entrainementBatch(paramDataset data, ParamMatrice dataMatrice, int temps, int nbThreads, int tailleLot){
+    int i, t;
+    double alpha;
+    int voisin;
+    int * bmus = malloc(data.tailleTab * sizeof(int));
+    double * sommes = allocAligne((size_t)dataMatrice.nbNeurone * dataMatrice.tailleVecPad * sizeof(double));
+    double * comptes = malloc(dataMatrice.nbNeurone * sizeof(double));
+    TacheBatch * taches = malloc(nbThreads * sizeof(TacheBatch));
+    Instrumentation * mesures;
+    double debutEpoque;
+    uint64_t graine;
+
+    for(t=0; t<nbThreads; t++){
+        taches[t].data = data;
+        taches[t].dataMatrice = dataMatrice;
+        taches[t].dataMatrice.distances = allocAligne(dataMatrice.nbNeurone * sizeof(double));
+        taches[t].bmus = bmus;
+        taches[t].seconds = NULL;
+        taches[t].distancesBMU = NULL;
+        taches[t].tailleLot = tailleLot;
+        taches[t].sommes = sommes;
+        taches[t].comptes = comptes;
+    }
+
+    for(i=0; i<temps; i++){
+        debutEpoque = chronometre();
+        planningApprentissage(i, temps, 0.0, &alpha, &voisin);
+        mesures = mesuresThreads(dataMatrice, nbThreads);
+        graine = tirerGenerateur(dataMatrice.generateur);
+
+        for(t=0; t<nbThreads; t++){ // partage des donnees
+            taches[t].debut = (int)((long)data.tailleTab * t / nbThreads);
+            taches[t].fin = (int)((long)data.tailleTab * (t+1) / nbThreads);
+            taches[t].graine = graine;
+            taches[t].voisin = voisin;
+            taches[t].dataMatrice.mesure = (mesures != NULL) ? &mesures[t] : NULL;
+        }
+        lancerThreads(nbThreads, batchAffectation, taches, sizeof(TacheBatch));
+        fusionnerMesures(dataMatrice, mesures, nbThreads);
+
+        for(t=0; t<nbThreads; t++){ // partage des neurones
+            taches[t].debut = (int)((long)dataMatrice.nbNeurone * t / nbThreads);
+            taches[t].fin = (int)((long)dataMatrice.nbNeurone * (t+1) / nbThreads);
+        }
+        lancerThreads(nbThreads, batchAccumulation, taches, sizeof(TacheBatch));
+        lancerThreads(nbThreads, batchMiseAJour, taches, sizeof(TacheBatch));
+
+        if(dataMatrice.mesure != NULL){ // chaque neurone est recalcule
+            dataMatrice.mesure->compteurs.nbMisesAJour += dataMatrice.nbNeurone;
+            noterEpoque(dataMatrice.mesure, chronometre() - debutEpoque);
+        }
+    }
+
+    for(t=0; t<nbThreads; t++){
+        libererAligne(taches[t].dataMatrice.distances);
+    }
+
+    free(taches);
+    free(comptes);
+    libererAligne(sommes);
+    free(bmus);
+}
+
+
+/**
+ * @brief Writes a whole buffer to a descriptor, retrying after partial writes.
+ *
+ * @param descripteur The descriptor.
+ * @param tampon The bytes to write.
+ * @param taille The number of bytes.
+ * @return 0 on success, -1 on error.
+ */
+int ecrireTout(int descripteur, const void * tampon, size_t taille){
+#ifndef _WIN32
+    const char * octets = tampon;
+    ssize_t ecrits;
+
+    while(taille > 0){
+        ecrits = write(descripteur, octets, taille);
+
+        if(ecrits <= 0){
+            return -1;
+        }
+        octets += ecrits;
+        taille -= (size_t)ecrits;
+    }
+
+    return 0;
+#else
+    (void)descripteur; (void)tampon; (void)taille;
+    return -1;
+#endif
+}
+
+
+/**
+ * @brief Reads a whole buffer from a descriptor, retrying after partial reads.
+ *
+ * @param descripteur The descriptor.
+ * @param tampon The destination.
+ * @param taille The number of bytes.
+ * @return 0 on success, -1 on error or if the peer closed the connection.
+ */
+int lireTout(int descripteur, void * tampon, size_t taille){
+#ifndef _WIN32
+    char * octets = tampon;
+    ssize_t lus;
+
+    while(taille > 0){
+        lus = read(descripteur, octets, taille);
+
+        if(lus <= 0){
+            return -1;
+        }
+        octets += lus;
+        taille -= (size_t)lus;
+    }
+
+    return 0;
+#else
+    (void)descripteur; (void)tampon; (void)taille;
+    return -1;
+#endif
+}
+
+
+/**
+ * @brief Tells whether a peer of the reduction has died.
+ *
+ * Rank 0 reaps its workers without blocking; a worker checks that rank 0, its parent, is
+ * still there (it would be adopted by another process otherwise).
+ *
+ * @param transport The transport.
+ * @return 1 if a peer has died, 0 otherwise.
+ */
+int pairDisparu(TransportReduction * transport){
+#ifndef _WIN32
+    int r, statut;
+
+    if(transport->rang != 0){
+        return getppid() != transport->parent;
+    }
+
+    for(r=1; r<transport->nbProcessus; r++){
+        if(transport->processus[r] > 0 && waitpid(transport->processus[r], &statut, WNOHANG) == transport->processus[r]){
+            transport->processus[r] = 0;
+            return 1;
+        }
+    }
+#else
+    (void)transport;
+#endif
+    return 0;
+}
+
+
+/**
+ * @brief Waits until every process of the reduction has reached the barrier.
+ *
+ * The wait wakes up every `PERIODE_SURVEILLANCE_MS` to check the peers (`pairDisparu`).
+ * A dead peer, or a process that died holding the mutex, aborts the barrier for everyone.
+ *
+ * @param transport The transport.
+ * @return 0 when all the processes have arrived, -1 if the reduction was abandoned.
+ */
+int attendreBarriere(TransportReduction * transport){
+#ifndef _WIN32
+    BarriereProcessus * barriere = transport->barriere;
+    struct timespec echeance;
+    unsigned generation;
+    int resultat, abandon;
+
+    if(pthread_mutex_lock(&barriere->verrou) == EOWNERDEAD){ // mort pendant la section critique
+        pthread_mutex_consistent(&barriere->verrou);
+        barriere->abandon = 1;
+    }
+
+    generation = barriere->generation;
+
+    if(++barriere->nbArrives == transport->nbProcessus){
+        barriere->nbArrives = 0;
+        barriere->generation++;
+        pthread_cond_broadcast(&barriere->condition);
+    }
+
+    while(barriere->generation == generation && !barriere->abandon){
+        clock_gettime(CLOCK_MONOTONIC, &echeance);
+        echeance.tv_nsec += PERIODE_SURVEILLANCE_MS * 1000000L;
+        echeance.tv_sec += echeance.tv_nsec / 1000000000L;
+        echeance.tv_nsec %= 1000000000L;
+        resultat = pthread_cond_timedwait(&barriere->condition, &barriere->verrou, &echeance);
+
+        if(resultat == EOWNERDEAD){
+            pthread_mutex_consistent(&barriere->verrou);
+            barriere->abandon = 1;
+        }
+        else if(resultat == ETIMEDOUT && pairDisparu(transport)){
+            barriere->abandon = 1;
+        }
+
+        if(barriere->abandon){
+            pthread_cond_broadcast(&barriere->condition);
+        }
+    }
+
+    abandon = barriere->abandon;
+    pthread_mutex_unlock(&barriere->verrou);
+
+    return abandon ? -1 : 0;
+#else
+    (void)transport;
+    return -1;
+#endif
+}
+
+
+/**
+ * @brief All-reduce through shared memory.
+ *
+ * Every rank copies its vector into its slot; after a barrier, rank r sums the r-th part of
+ * all the slots, in rank order, into the result (reduce-scatter); after a second barrier,
+ * every rank copies the whole result. The barrier of the next call keeps a rank from writing
+ * the result while another one is still copying it.
+ *
+ * @param transport The transport.
+ * @param tampon The vector of the rank, replaced by the sum.
+ * @return 0 on success, -1 if a process died (see `attendreBarriere`).
+ */
+int reductionMemoire(TransportReduction * transport, double * tampon){
+#ifndef _WIN32
+    size_t i, debut, fin;
+    int r;
+
+    debut = transport->taille * transport->rang / transport->nbProcessus;
+    fin = transport->taille * (transport->rang + 1) / transport->nbProcessus;
+
+    memcpy(transport->emplacements + transport->taille * transport->rang, tampon, transport->taille * sizeof(double));
+
+    if(attendreBarriere(transport) != 0){
+        return -1;
+    }
+
+    for(i=debut; i<fin; i++){
+        transport->resultat[i] = transport->emplacements[i];
+    }
+
+    for(r=1; r<transport->nbProcessus; r++){
+        for(i=debut; i<fin; i++){
+            transport->resultat[i] += transport->emplacements[transport->taille * r + i];
+        }
+    }
+
+    if(attendreBarriere(transport) != 0){
+        return -1;
+    }
+    memcpy(tampon, transport->resultat, transport->taille * sizeof(double));
+#else
+    (void)transport; (void)tampon;
+#endif
+    return 0;
+}
+
+
+/**
+ * @brief All-reduce through Unix sockets.
+ *
+ * Rank 0 receives the vectors of ranks 1, 2 ... in that order and adds them to its own, then
+ * sends the sum back to every rank.
+ *
+ * @param transport The transport.
+ * @param tampon The vector of the rank, replaced by the sum.
+ * @return 0 on success, -1 if a process did not answer.
+ */
+int reductionSocket(TransportReduction * transport, double * tampon){
+    size_t i, octets = transport->taille * sizeof(double);
+    int r, descripteur;
+
+    if(transport->rang != 0){
+        descripteur = transport->descripteurs[2*transport->rang + 1];
+
+        if(ecrireTout(descripteur, tampon, octets) != 0 || lireTout(descripteur, tampon, octets) != 0){
+            return -1;
+        }
+
+        return 0;
+    }
+
+    for(r=1; r<transport->nbProcessus; r++){
+        if(lireTout(transport->descripteurs[2*r], transport->recu, octets) != 0){
+            return -1;
+        }
+
+        for(i=0; i<transport->taille; i++){
+            tampon[i] += transport->recu[i];
+        }
+    }
+
+    for(r=1; r<transport->nbProcessus; r++){
+        if(ecrireTout(transport->descripteurs[2*r], tampon, octets) != 0){
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief Creates the reduction transport of a group of processes, before they are forked.
+ *
+ * The shared memory transport maps an anonymous shared zone holding the barrier of the
+ * processes (`BarriereProcessus`), one slot per rank and the result. The socket transport opens one pair of Unix sockets
+ * between rank 0 and every other rank.
+ *
+ * @param transport The transport to create (to be released with `libererTransport`, even on failure).
+ * @param type The kind of transport.
+ * @param nbProcessus The number of processes.
+ * @param taille The number of doubles of the reduced vectors.
+ * @param processus The array receiving the process ids of the ranks, filled by the caller after the fork.
+ * @return 0 on success, -1 if the transport cannot be created (always on Windows).
+ */
+int creerTransport(TransportReduction * transport, typeTransport type, int nbProcessus, size_t taille, pid_t * processus){
+    int r;
+#ifndef _WIN32
+    pthread_mutexattr_t attributsVerrou;
+    pthread_condattr_t attributsCondition;
+    size_t tailleBarriere = (sizeof(BarriereProcessus) + ALIGNEMENT_CACHE - 1) / ALIGNEMENT_CACHE * ALIGNEMENT_CACHE;
+#endif
+
+    memset(transport, 0, sizeof(TransportReduction));
+    transport->type = type;
+    transport->nbProcessus = nbProcessus;
+    transport->taille = taille;
+    transport->processus = processus;
+#ifndef _WIN32
+    transport->parent = getpid();
+#endif
+
+#ifndef _WIN32
+    if(type == TRANSPORT_MEMOIRE){
+        transport->reduire = reductionMemoire;
+        transport->tailleZone = tailleBarriere + (size_t)(nbProcessus + 1) * taille * sizeof(double);
+        transport->zone = mmap(NULL, transport->tailleZone, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+        if(transport->zone == MAP_FAILED){
+            transport->zone = NULL;
+            return -1;
+        }
+
+        transport->barriere = (BarriereProcessus*)transport->zone;
+        transport->emplacements = (double*)(transport->zone + tailleBarriere);
+        transport->resultat = transport->emplacements + (size_t)nbProcessus * taille;
+
+        pthread_mutexattr_init(&attributsVerrou);
+        pthread_mutexattr_setpshared(&attributsVerrou, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&attributsVerrou, PTHREAD_MUTEX_ROBUST);
+        pthread_condattr_init(&attributsCondition);
+        pthread_condattr_setpshared(&attributsCondition, PTHREAD_PROCESS_SHARED);
+        pthread_condattr_setclock(&attributsCondition, CLOCK_MONOTONIC);
+        r = pthread_mutex_init(&transport->barriere->verrou, &attributsVerrou);
+
+        if(r == 0 && (r = pthread_cond_init(&transport->barriere->condition, &attributsCondition)) != 0){
+            pthread_mutex_destroy(&transport->barriere->verrou);
+        }
+        pthread_mutexattr_destroy(&attributsVerrou);
+        pthread_condattr_destroy(&attributsCondition);
+
+        if(r != 0){
+            munmap(transport->zone, transport->tailleZone);
+            transport->zone = NULL;
+            return -1;
+        }
+
+        return 0;
+    }
+
+    transport->reduire = reductionSocket;
+    transport->descripteurs = malloc(2 * nbProcessus * sizeof(int));
+    transport->recu = malloc(taille * sizeof(double));
+
+    for(r=0; r<2*nbProcessus; r++){
+        transport->descripteurs[r] = -1;
+    }
+
+    for(r=1; r<nbProcessus; r++){
+        if(socketpair(AF_UNIX, SOCK_STREAM, 0, transport->descripteurs + 2*r) != 0){
+            return -1;
+        }
+    }
+
+    return 0;
+#else
+    (void)r;
+    return -1;
+#endif
+}
+
+
+/**
+ * @brief Sets up the transport in one process after the fork.
+ *
+ * With sockets, the process closes the ends it does not use, so that a process that dies
+ * makes the reads of its peer fail instead of blocking.
+ *
+ * @param transport The transport created by `creerTransport`.
+ * @param rang The rank of the process.
+ */
+void rejoindreTransport(TransportReduction * transport, int rang){
+    int r;
+
+    transport->rang = rang;
+
+    if(transport->descripteurs == NULL){
+        return;
+    }
+
+    for(r=1; r<transport->nbProcessus; r++){
+#ifndef _WIN32
+        if(rang == 0 || r != rang){
+            close(transport->descripteurs[2*r + 1]);
+            transport->descripteurs[2*r + 1] = -1;
+        }
+
+        if(rang != 0){
+            close(transport->descripteurs[2*r]);
+            transport->descripteurs[2*r] = -1;
+        }
+#endif
+    }
+}
+
+
+/**
+ * @brief Releases the transport in one process.
+ *
+ * @param transport The transport.
+ */
+void libererTransport(TransportReduction * transport){
+    int r;
+
+#ifndef _WIN32
+    if(transport->zone != NULL){
+        if(transport->rang == 0 && transport->barriere != NULL){
+            pthread_cond_destroy(&transport->barriere->condition);
+            pthread_mutex_destroy(&transport->barriere->verrou);
+        }
+        munmap(transport->zone, transport->tailleZone);
+    }
+
+    for(r=0; transport->descripteurs != NULL && r<2*transport->nbProcessus; r++){
+        if(transport->descripteurs[r] >= 0){
+            close(transport->descripteurs[r]);
+        }
+    }
+#else
+    (void)r;
+#endif
+
+    free(transport->descripteurs);
+    free(transport->recu);
+}
+
+
+/**
+ * @brief Trains the map with the batch SOM rule on several processes (data parallelism).
+ *
+ * Rank 0 (the calling process) forks `nbProcessus - 1` workers; each process owns a contiguous
+ * shard of the data points and a replica of the codebook. At every epoch each process finds the
+ * BMUs of its shard (ties keyed by the global index of the data point, as in `entrainementBatch`)
+ * and sums its data points per neuron; the accumulators (sums and counts of all the neurons)
+ * are then all-reduced through the transport, and every process applies the same update
+ * (`batchMiseAJour`) to its replica, so the replicas stay identical without broadcasting the
+ * codebook. The accumulators are added in rank order by both transports: the map does not depend
+ * on the transport, and with one process it is the map of `entrainementBatch`.
+ *
+ * The workers share the pages of the loaded dataset with rank 0 (copy on write) but only read
+ * their shard. Rank 0 prints the compute and communication times of every epoch (the
+ * communication includes the wait for the slowest process) and keeps the trained map; the
+ * workers exit at the end. The counters of `--stats` cover the shard of rank 0. If a process
+ * dies, the reduction fails in the others (end of file on a socket, abandoned barrier in shared
+ * memory) and rank 0 stops the remaining workers.
+ *
+ * @param data The dataset (read only).
+ * @param dataMatrice The neuron matrix to train (in rank 0).
+ * @param temps The number of epochs.
+ * @param nbProcessus The number of processes.
+ * @param type The transport of the reduction.
+ * @param tailleLot The mini-batch size of the BMU assignment (1 = one data point at a time).
+ * @return 0 on success, -1 if the processes or the transport could not be set up or a worker failed.
+ */
+int entrainementDistribue(paramDataset data, ParamMatrice dataMatrice, int temps, int nbProcessus, typeTransport type, int tailleLot){
+#ifndef _WIN32
+    TransportReduction transport;
+    TacheBatch tache;
+    size_t taille = (size_t)dataMatrice.nbNeurone * dataMatrice.tailleVecPad + dataMatrice.nbNeurone;
+    double * accumulateurs = allocAligne(taille * sizeof(double));
+    pid_t * processus = malloc(nbProcessus * sizeof(pid_t));
+    int i, p, rang = 0, voisin, statut, premier, erreur = 0;
+    double alpha, debutEpoque, debutEchange, calcul, communication, totalCalcul = 0.0, totalCommunication = 0.0;
+    uint64_t graine;
+
+    if(creerTransport(&transport, type, nbProcessus, taille, processus) != 0){
+        libererTransport(&transport);
+        free(processus);
+        libererAligne(accumulateurs);
+        return -1;
+    }
+
+    fflush(stdout); // sinon les processus fils reecriraient le tampon du pere
+
+    for(p=1; p<nbProcessus; p++){
+        processus[p] = fork();
+
+        if(processus[p] == 0){
+            rang = p;
+            break;
+        }
+
+        if(processus[p] < 0){ // les processus deja lances ne termineront pas leur reduction
+            for(i=1; i<p; i++){
+                kill(processus[i], SIGKILL);
+                waitpid(processus[i], NULL, 0);
+            }
+            libererTransport(&transport);
+            free(processus);
+            libererAligne(accumulateurs);
+            return -1;
+        }
+    }
+
+    rejoindreTransport(&transport, rang);
+
+    premier = (int)((long)data.tailleTab * rang / nbProcessus);
+    tache.data = data;
+    tache.data.mesDataset = data.mesDataset + premier;
+    tache.data.tailleTab = (int)((long)data.tailleTab * (rang + 1) / nbProcessus) - premier;
+    tache.dataMatrice = dataMatrice;
+    tache.bmus = malloc((tache.data.tailleTab > 0 ? tache.data.tailleTab : 1) * sizeof(int));
+    tache.seconds = NULL;
+    tache.distancesBMU = NULL;
+    tache.tailleLot = tailleLot;
+    tache.sommes = accumulateurs;
+    tache.comptes = accumulateurs + (size_t)dataMatrice.nbNeurone * dataMatrice.tailleVecPad;
+
+    if(rang == 0){
+        printf("apprentissage sur %d processus, reduction par %s de %.2f Mo par epoque\n", nbProcessus,
+               (type == TRANSPORT_MEMOIRE) ? "memoire partagee" : "sockets Unix", taille * sizeof(double) / 1e6);
+    }
+
+    for(i=0; i<temps && !erreur; i++){
+        debutEpoque = chronometre();
+        planningApprentissage(i, temps, 0.0, &alpha, &voisin);
+        graine = tirerGenerateur(dataMatrice.generateur); // meme tirage dans chaque processus
+
+        tache.voisin = voisin;
+        tache.graine = graine + (uint64_t)premier; // egalites selon l'indice global de la donnee
+        tache.debut = 0;
+        tache.fin = tache.data.tailleTab;
+        batchAffectation(&tache);
+        tache.fin = dataMatrice.nbNeurone;
+        batchAccumulation(&tache);
+
+        debutEchange = chronometre();
+        erreur = transport.reduire(&transport, accumulateurs) != 0;
+        communication = chronometre() - debutEchange;
+
+        batchMiseAJour(&tache);
+        calcul = chronometre() - debutEpoque - communication;
+        totalCalcul += calcul;
+        totalCommunication += communication;
+
+        if(rang == 0){
+            printf("epoque %d : calcul %.3f s, communication %.3f s\n", i, calcul, communication);
+
+            if(dataMatrice.mesure != NULL){
+                dataMatrice.mesure->compteurs.nbMisesAJour += dataMatrice.nbNeurone;
+                noterEpoque(dataMatrice.mesure, chronometre() - debutEpoque);
+            }
+        }
+    }
+
+    free(tache.bmus);
+    libererTransport(&transport);
+    libererAligne(accumulateurs);
+
+    if(rang != 0){
+        _exit(erreur ? 1 : 0);
+    }
+
+    if(erreur){
+        printf("reduction interrompue : un processus s'est arrete\n");
+    }
+
+    for(p=1; p<nbProcessus; p++){
+        if(processus[p] <= 0){ // deja recupere par pairDisparu
+            erreur = 1;
+            continue;
+        }
+
+        if(erreur){ // un processus bloque ailleurs ne doit pas bloquer le pere
+            kill(processus[p], SIGKILL);
+        }
+        erreur |= waitpid(processus[p], &statut, 0) < 0 || !WIFEXITED(statut) || WEXITSTATUS(statut) != 0;
+    }
+    free(processus);
+
+    printf("processus : calcul %.3f s, communication %.3f s (%.1f %% du temps d'apprentissage)\n\n", totalCalcul, totalCommunication,
+           (totalCalcul + totalCommunication > 0.0) ? 100.0 * totalCommunication / (totalCalcul + totalCommunication) : 0.0);
+
+    return erreur ? -1 : 0;
+#else
+    (void)data; (void)dataMatrice; (void)temps; (void)nbProcessus; (void)type; (void)tailleLot;
+    return -1;
+#endif
+}
+
+
+/**
+ * @brief Opens a text dataset for streaming.
+ *
+ * The first non-empty record is read to find the dimension (number of delimiters) and is
+ * kept for the first window. The name "-" reads the standard input, which cannot be rewound.
+ * The windows are shuffled with the stream of `graine` moved one jump ahead, so the shuffles
+ * do not reuse the draws of a training generator created from the same seed.
+ *
+ * @param lecteur The reader to initialize.
+ * @param nomFichier The name of the file, or "-" for the standard input.
+ * @param delimiteur The field delimiter.
+ * @param tailleFenetre The maximum number of records per window.
+ * @param graine The seed of the window shuffles.
+ * @return 0 on success, -1 if the input cannot be opened or is empty.
+ */
+int ouvrirFlux(LecteurFlux * lecteur, char * nomFichier, char * delimiteur, int tailleFenetre, uint64_t graine){
+    int parLigne = ALIGNEMENT_CACHE / sizeof(reel);
+    ssize_t lus;
+    char * c;
+
+    memset(lecteur, 0, sizeof(LecteurFlux));
+    lecteur->relisible = strcmp(nomFichier, "-") != 0;
+    lecteur->fichier = lecteur->relisible ? fopen(nomFichier, "r") : stdin;
+    lecteur->delimiteur = delimiteur[0];
+    lecteur->tailleFenetre = tailleFenetre;
+    lecteur->generateur = creerGenerateur(graine);
+    sauterGenerateur(&lecteur->generateur);
+
+    if(lecteur->fichier == NULL){
+        return -1;
+    }
+
+    while((lus = getline(&lecteur->ligne, &lecteur->capaciteLigne, lecteur->fichier)) >= 0
+          && ligneVide(lecteur->ligne, 0, (size_t)lus)){
+    }
+
+    if(lus < 0){
+        return -1;
+    }
+
+    lecteur->lignePendante = 1;
+
+    for(c=lecteur->ligne; *c!='\0'; c++){
+        if(*c == lecteur->delimiteur){
+            lecteur->tailleVec++;
+        }
+    }
+
+    lecteur->tailleVecPad = (lecteur->tailleVec + parLigne - 1) / parLigne * parLigne;
+    lecteur->fenetre = allocAligne((size_t)tailleFenetre * lecteur->tailleVecPad * sizeof(reel));
+    memset(lecteur->fenetre, 0, (size_t)tailleFenetre * lecteur->tailleVecPad * sizeof(reel));
+    lecteur->classes = malloc(tailleFenetre * sizeof(int));
+    lecteur->ordre = malloc(tailleFenetre * sizeof(int));
+
+    return 0;
+}
+
+
+/**
+ * @brief Goes back to the start of the input for another pass.
+ *
+ * @param lecteur The reader.
+ * @return 0 on success, -1 if the input cannot be rewound (standard input).
+ */
+int rembobinerFlux(LecteurFlux * lecteur){
+    if(!lecteur->relisible || fseek(lecteur->fichier, 0, SEEK_SET) != 0){
+        return -1;
+    }
+
+    lecteur->lignePendante = 0;
+
+    return 0;
+}
+
+
+/**
+ * @brief Reads the next window of records.
+ *
+ * Each record is parsed, normalized (like `NormaliserVecteur`) and stored in the window
+ * buffer; its label is interned in the dictionary. The window is then shuffled
+ * (`melangerIndices` on `ordre`), so the records reach the training in random order within
+ * the window while memory stays bounded by its size.
+ *
+ * @param lecteur The reader.
+ * @param dico The label dictionary.
+ * @return The number of records of the window (0 at the end of the input).
+ */
+int lireFenetre(LecteurFlux * lecteur, DictionnaireEtiquettes * dico){
+    int nbLignes = 0, d, k;
+    ssize_t lus;
+    double norme;
+    reel * vecteur;
+    const char * etiquette;
+    size_t longueur;
+
+    while(nbLignes < lecteur->tailleFenetre){
+
+        if(!lecteur->lignePendante){
+            lus = getline(&lecteur->ligne, &lecteur->capaciteLigne, lecteur->fichier);
+
+            if(lus < 0){
+                break;
+            }
+
+            if(ligneVide(lecteur->ligne, 0, (size_t)lus)){
+                continue;
+            }
+        }
+        else{
+            lus = (ssize_t)strlen(lecteur->ligne);
+        }
+        lecteur->lignePendante = 0;
+        lecteur->nbOctets += lus;
+
+        if(lus > 0 && lecteur->ligne[lus-1] == '\n'){
+            lus--;
+        }
+
+        vecteur = lecteur->fenetre + (size_t)nbLignes * lecteur->tailleVecPad;
+        lecteur->nbErreurs += analyserLigne(lecteur->ligne, lecteur->ligne + lus, lecteur->delimiteur, lecteur->tailleVec,
+                                            vecteur, &etiquette, &longueur);
+
+        norme = 0.0;
+
+        for(d=0; d<lecteur->tailleVec; d++){
+            norme += vecteur[d] * vecteur[d];
+        }
+
+        norme = sqrt(norme);
+
+        for(d=0; d<lecteur->tailleVec; d++){
+            vecteur[d] /= norme;
+        }
+
+        lecteur->classes[nbLignes] = internerEtiquette(dico, etiquette, longueur);
+
+        nbLignes++;
+    }
+
+    for(k=0; k<nbLignes; k++){
+        lecteur->ordre[k] = k;
+    }
+
+    melangerIndices(lecteur->ordre, nbLignes, &lecteur->generateur); // melange de la fenetre
+
+    return nbLignes;
+}
+
+
+/**
+ * @brief Releases a stream reader.
+ *
+ * @param lecteur The reader.
+ */
+void fermerFlux(LecteurFlux * lecteur){
+    if(lecteur->fichier != NULL && lecteur->relisible){
+        fclose(lecteur->fichier);
+    }
+
+    free(lecteur->ligne);
+    libererAligne(lecteur->fenetre);
+    free(lecteur->classes);
+    free(lecteur->ordre);
+}
+
+
+/**
+ * @brief Trains, labels and evaluates a map from a stream, without loading the dataset.
+ *
+ * The input is read one window at a time (`lireFenetre`), so memory depends on the window
+ * size and the map, never on the size of the dataset. Without `--neurons`, a regular file is read
+ * once more to count its records, so the map gets the default size of the in-memory mode; the
+ * standard input cannot be counted and needs `--neurons`. The codebook is initialized around the
+ * mean of the first window, then every record of every window goes through the online rule
+ * (`rechercheBMU` and `apprentissage`). A regular file is read once per epoch, following
+ * `planningApprentissage`; the standard input is read once, and the schedule then advances
+ * by one step per window, `--epochs` giving the number of windows it spans.
+ *
+ * A last pass labels each neuron with the majority class of the records it wins (as
+ * `etiquetageCarte`) and measures the quantization and topographic errors. On the standard input, this is
+ * done during the training pass, on the moving codebook.
+ *
+ * @param param The run configuration (`fichier` may be "-" for the standard input).
+ * @return The exit code of the program.
+ */
+int entrainementFlux(ParamExecution param){
+    LecteurFlux lecteur;
+    DictionnaireEtiquettes dico = creerDictionnaire();
+    ParamMatrice dataMatrice;
+    BMU bmu;
+    reel * moyenne;
+    int * histogramme;
+    int capaciteHistogramme = 8, nouvelleCapacite, c;
+    reel * vecteur;
+    int nbLignes, i, k, b, d, etape = 0, voisin = 1, evaluation;
+    long nbDonnees = 0, nbNonVoisin = 0, nbTotal = 0;
+    double alpha = param.alpha, sommeDistance = 0.0, debut = chronometre(), debutPasse;
+    Instrumentation mesure = creerInstrumentation(1);
+    Generateur generateur = creerGenerateur(param.graine);
+
+    if(ouvrirFlux(&lecteur, param.fichier, param.delimiteur, param.tailleFenetre, param.graine) != 0){
+        printf("impossible d'ouvrir le fichier");
+        libererDictionnaire(dico);
+        return 1;
+    }
+
+    if(param.nbNeurone == 0){ // taille par defaut du mode en memoire : une passe de comptage
+        if(!lecteur.relisible){
+            printf("--neurons est obligatoire sur l'entree standard : le nombre de donnees n'est pas connu a l'avance\n");
+            fermerFlux(&lecteur);
+            libererDictionnaire(dico);
+            libererInstrumentation(mesure);
+            return 1;
+        }
+
+        while((nbLignes = lireFenetre(&lecteur, &dico)) > 0){
+            nbTotal += nbLignes;
+        }
+        rembobinerFlux(&lecteur);
+        lecteur.nbErreurs = 0;
+    }
+
+    // initialisation autour de la moyenne de la premiere fenetre
+    nbLignes = lireFenetre(&lecteur, &dico);
+    moyenne = calloc(lecteur.tailleVec, sizeof(reel));
+
+    for(k=0; k<nbLignes; k++){
+        for(d=0; d<lecteur.tailleVec; d++){
+            moyenne[d] += lecteur.fenetre[(size_t)k * lecteur.tailleVecPad + d] / nbLignes;
+        }
+    }
+
+    memset(&dataMatrice, 0, sizeof(dataMatrice));
+    dataMatrice = genererMatriceNeurone(dataMatrice, (param.nbNeurone > 0) ? param.nbNeurone : 5*sqrt(nbTotal), lecteur.tailleVec);
+    dataMatrice.generateur = &generateur;
+    genereVecteurDouble(dataMatrice, 0.3, 0.3, moyenne);
+    dataMatrice = preparerTableVoisinage(dataMatrice, param.voisinage, RAYON_VOISINAGE_MAX);
+    dataMatrice.abandon = param.abandon;
+    dataMatrice.mesure = (param.fichierStats != NULL) ? &mesure : NULL;
+    mesurerPhase(&mesure, PHASE_INITIALISATION, debut);
+    histogramme = calloc((size_t)dataMatrice.nbNeurone * capaciteHistogramme, sizeof(int));
+
+    // passes d'apprentissage, puis une passe d'etiquetage si l'entree est relisible
+    for(i=0; i<=param.temps && nbLignes > 0; i++){
+        evaluation = (i == param.temps) || !lecteur.relisible;
+        debutPasse = chronometre();
+
+        if(lecteur.relisible){
+            planningApprentissage(i < param.temps ? i : param.temps-1, param.temps, param.alpha, &alpha, &voisin);
+        }
+
+        while(nbLignes > 0){
+
+            if(!lecteur.relisible){
+                planningApprentissage(etape < param.temps ? etape : param.temps-1, param.temps, param.alpha, &alpha, &voisin);
+                etape++;
+            }
+
+            for(b=0; b<nbLignes; b++){
+                k = lecteur.ordre[b];
+                vecteur = lecteur.fenetre + (size_t)k * lecteur.tailleVecPad;
+                bmu = trouverBMU(dataMatrice, vecteur, dataMatrice.generateur);
+
+                if(evaluation){
+                    if(dico.nbNoms > capaciteHistogramme){ // nouvelles classes
+                        nouvelleCapacite = (2 * capaciteHistogramme > dico.nbNoms) ? 2 * capaciteHistogramme : dico.nbNoms;
+                        histogramme = realloc(histogramme, (size_t)dataMatrice.nbNeurone * nouvelleCapacite * sizeof(int));
+
+                        for(d=dataMatrice.nbNeurone-1; d>=0; d--){
+                            for(c=nouvelleCapacite-1; c>=0; c--){
+                                histogramme[(size_t)d * nouvelleCapacite + c] = (c < capaciteHistogramme) ? histogramme[(size_t)d * capaciteHistogramme + c] : 0;
+                            }
+                        }
+                        capaciteHistogramme = nouvelleCapacite;
+                    }
+
+                    histogramme[(size_t)bmu.indice * capaciteHistogramme + lecteur.classes[k]]++;
+                    nbDonnees++;
+                    sommeDistance += sqrt(bmu.distance);
+
+                    if(bmu.indiceSecond >= 0 && (abs(bmu.x - bmu.indiceSecond / dataMatrice.longueur) > 1
+                                                 || abs(bmu.y - bmu.indiceSecond % dataMatrice.longueur) > 1)){
+                        nbNonVoisin++;
+                    }
+                }
+
+                if(i < param.temps){
+                    apprentissage(bmu, dataMatrice, alpha, lecteur.tailleVec, voisin, vecteur);
+                }
+            }
+
+            nbLignes = lireFenetre(&lecteur, &dico);
+        }
+
+        if(i < param.temps){ // passe d'apprentissage
+            mesurerPhase(&mesure, PHASE_APPRENTISSAGE, debutPasse);
+            noterEpoque(&mesure, chronometre() - debutPasse);
+        }
+        else{
+            mesurerPhase(&mesure, PHASE_ETIQUETAGE, debutPasse);
+        }
+
+        if(!lecteur.relisible || rembobinerFlux(&lecteur) != 0){
+            break;
+        }
+        nbLignes = lireFenetre(&lecteur, &dico);
+    }
+
+    if(lecteur.nbErreurs > 0){
+        printf("attention : %ld ligne(s) mal formee(s) dans %s\n", lecteur.nbErreurs, param.fichier);
+    }
+    printf("flux : %ld donnees par passe, fenetre de %d, %.3f s\n\n", nbDonnees, param.tailleFenetre, chronometre() - debut);
+
+    etiquetterHistogramme(dataMatrice, histogramme, capaciteHistogramme);
+    afficheEtiquette(dataMatrice, dico);
+
+    printf("\nerreur de quantification : %f\nerreur topographique : %f\n",
+           nbDonnees > 0 ? sommeDistance / nbDonnees : 0.0, nbDonnees > 0 ? (double)nbNonVoisin / nbDonnees : 0.0);
+
+    if(param.fichierModele != NULL){
+        debutPasse = chronometre();
+
+        if(ecrireModele(dataMatrice, moyenne, dico, param.fichierModele) != 0){
+            printf("impossible d'ecrire %s\n", param.fichierModele);
+        }
+        else{
+            printf("modele ecrit dans %s\n", param.fichierModele);
+        }
+        mesurerPhase(&mesure, PHASE_MODELE, debutPasse);
+    }
+
+    if(param.fichierStats != NULL){
+        mesure.octetsCharges = lecteur.nbOctets;
+
+        if(ecrireRapport(&mesure, param.fichierStats, "flux") != 0){
+            printf("impossible d'ecrire %s\n", param.fichierStats);
+        }
+    }
+    libererInstrumentation(mesure);
+
+    libererMatrice(dataMatrice);
+    free(histogramme);
+    free(moyenne);
+    fermerFlux(&lecteur);
+    libererDictionnaire(dico);
+
+    return 0;
+}
+
+
+/**
+ * @brief Projects a slice of a window onto the map and formats its output lines.
+ *
+ * Each record gets a line "x,y,distance,label": the grid position of its BMU, the distance
+ * to the BMU (quantization error of the record) and the label of the BMU ('?' if none).
+ *
+ * @param arg A pointer to the `TacheProjection` of the thread.
+ * @return NULL.
+ */
+void * projeterTranche(void * arg){
+    TacheProjection * tache = arg;
+    TacheBatch * affectation = &tache->affectation;
+    int k, longueur, classe, colonnes = affectation->dataMatrice.longueur;
+
+    batchAffectation(affectation);
+    tache->tailleTexte = 0;
+
+    for(k=affectation->debut; k<affectation->fin; k++){
+        classe = affectation->dataMatrice.classes[affectation->bmus[k]];
+
+        while(1){
+            longueur = snprintf(tache->texte + tache->tailleTexte, tache->capaciteTexte - tache->tailleTexte, "%d,%d,%.9g,%s\n",
+                                affectation->bmus[k] / colonnes, affectation->bmus[k] % colonnes,
+                                sqrt(affectation->distancesBMU[k]), (classe >= 0) ? tache->noms[classe] : "?");
+
+            if(tache->tailleTexte + longueur < tache->capaciteTexte){
+                break;
+            }
+
+            tache->capaciteTexte = 2 * tache->capaciteTexte + longueur;
+            tache->texte = realloc(tache->texte, tache->capaciteTexte);
+        }
+
+        tache->tailleTexte += longueur;
+    }
+
+    return NULL;
+}
+
+
+/**
+ * @brief Projects a stream of records onto a trained model and writes one line per record.
+ *
+ * The records are read one window at a time (`lireFenetre`) and normalized like the training
+ * set; each window is split between the threads, which find the BMUs with the distance kernels
+ * of the model (`batchAffectation`, mini-batch distances when `--minibatch` > 1) and format
+ * their lines. The lines are written in input order, after a header line. Ties are broken with a
+ * seed derived from the position of the record in the input, so the output does not depend on
+ * the number of threads nor on the window size. Memory depends on the window size and the map,
+ * never on the size of the input.
+ *
+ * @param param The run configuration (`modele`, `fichier` and `sortieProjection`, "-" for the
+ *              standard input and output).
+ * @return The exit code of the program.
+ */
+int projectionFlux(ParamExecution param){
+    LecteurFlux lecteur;
+    DictionnaireEtiquettes dico;
+    Modele modele;
+    paramDataset fenetre;
+    TacheProjection * taches;
+    FILE * sortie, * journal = stdout;
+    int nbLignes, k, t, erreur = 0;
+    long nbDonnees = 0;
+    double debut = chronometre(), duree;
+    Instrumentation mesure = creerInstrumentation(param.nbThreads);
+    Instrumentation * mesures;
+
+    modele = chargerModele(param.modele);
+    mesurerPhase(&mesure, PHASE_MODELE, debut);
+
+    if(modele.projection == NULL){
+        return 1;
+    }
+
+    if(param.fichierStats != NULL){
+        modele.carte.mesure = &mesure;
+    }
+
+    if(ouvrirFlux(&lecteur, param.fichier, param.delimiteur, param.tailleFenetre, param.graine) != 0){
+        printf("impossible d'ouvrir le fichier");
+        libererModele(modele);
+        return 1;
+    }
+
+    if(lecteur.tailleVec != modele.carte.tailleVec){
+        printf("le modele %s attend %d dimensions, les donnees en ont %d\n", param.modele, modele.carte.tailleVec, lecteur.tailleVec);
+        fermerFlux(&lecteur);
+        libererModele(modele);
+        return 1;
+    }
+
+    if(strcmp(param.sortieProjection, "-") == 0){
+        sortie = stdout;
+        journal = stderr;
+    }
+    else{
+        sortie = fopen(param.sortieProjection, "w");
+    }
+
+    if(sortie == NULL){
+        printf("impossible d'ecrire %s\n", param.sortieProjection);
+        fermerFlux(&lecteur);
+        libererModele(modele);
+        return 1;
+    }
+
+    modele.carte.abandon = param.abandon;
+    memset(&fenetre, 0, sizeof(fenetre));
+    fenetre.tailleVec = lecteur.tailleVec;
+    fenetre.tailleVecPad = lecteur.tailleVecPad;
+    fenetre.mesDataset = malloc(param.tailleFenetre * sizeof(dataset));
+    taches = malloc(param.nbThreads * sizeof(TacheProjection));
+
+    for(k=0; k<param.tailleFenetre; k++){
+        fenetre.mesDataset[k].vecteur = lecteur.fenetre + (size_t)k * lecteur.tailleVecPad;
+        fenetre.mesDataset[k].norme = 1.0;
+        fenetre.mesDataset[k].classe = -1;
+    }
+
+    for(t=0; t<param.nbThreads; t++){
+        taches[t].affectation.dataMatrice = modele.carte;
+        taches[t].affectation.dataMatrice.distances = allocAligne(modele.carte.nbNeurone * sizeof(double));
+        taches[t].affectation.bmus = malloc(param.tailleFenetre * sizeof(int));
+        taches[t].affectation.seconds = malloc(param.tailleFenetre * sizeof(int));
+        taches[t].affectation.distancesBMU = malloc(param.tailleFenetre * sizeof(double));
+        taches[t].affectation.tailleLot = param.tailleLot;
+        taches[t].noms = modele.dico.noms;
+        taches[t].capaciteTexte = 4096;
+        taches[t].texte = malloc(taches[t].capaciteTexte);
+    }
+
+    fprintf(sortie, "x,y,distance,etiquette\n");
+
+    while(1){
+        dico = creerDictionnaire(); // etiquettes de l'entree, ignorees
+        nbLignes = lireFenetre(&lecteur, &dico);
+        libererDictionnaire(dico);
+
+        if(nbLignes == 0){
+            break;
+        }
+
+        fenetre.tailleTab = nbLignes;
+        mesures = mesuresThreads(modele.carte, param.nbThreads);
+
+        for(t=0; t<param.nbThreads; t++){
+            taches[t].affectation.data = fenetre;
+            taches[t].affectation.dataMatrice.mesure = (mesures != NULL) ? &mesures[t] : NULL;
+            taches[t].affectation.debut = (int)((long)nbLignes * t / param.nbThreads);
+            taches[t].affectation.fin = (int)((long)nbLignes * (t+1) / param.nbThreads);
+            // egalites tirees selon l'indice global de la donnee : independantes de la fenetre et des threads
+            taches[t].affectation.graine = GRAINE_ETIQUETAGE + (uint64_t)nbDonnees;
+        }
+
+        lancerThreads(param.nbThreads, projeterTranche, taches, sizeof(TacheProjection));
+        fusionnerMesures(modele.carte, mesures, param.nbThreads);
+
+        for(t=0; t<param.nbThreads; t++){
+            erreur |= fwrite(taches[t].texte, 1, taches[t].tailleTexte, sortie) != taches[t].tailleTexte;
+        }
+
+        nbDonnees += nbLignes;
+    }
+
+    if(sortie != stdout){
+        erreur |= fclose(sortie) != 0;
+    }
+    else{
+        erreur |= fflush(sortie) != 0;
+    }
+
+    duree = chronometre() - debut;
+
+    if(lecteur.nbErreurs > 0){
+        fprintf(journal, "attention : %ld ligne(s) mal formee(s) dans %s\n", lecteur.nbErreurs, param.fichier);
+    }
+
+    if(erreur){
+        fprintf(journal, "impossible d'ecrire %s\n", param.sortieProjection);
+    }
+    fprintf(journal, "projection : %ld lignes en %.3f s (%.0f lignes/s), %d thread(s), fenetre de %d\n",
+            nbDonnees, duree, (duree > 0.0) ? nbDonnees / duree : 0.0, param.nbThreads, param.tailleFenetre);
+
+    if(param.fichierStats != NULL){
+        mesure.phases[PHASE_PROJECTION] = duree - mesure.phases[PHASE_MODELE];
+        mesure.octetsCharges = lecteur.nbOctets;
+
+        if(ecrireRapport(&mesure, param.fichierStats, "projection") != 0){
+            fprintf(journal, "impossible d'ecrire %s\n", param.fichierStats);
+        }
+    }
+    libererInstrumentation(mesure);
+
+    for(t=0; t<param.nbThreads; t++){
+        libererAligne(taches[t].affectation.dataMatrice.distances);
+        free(taches[t].affectation.bmus);
+        free(taches[t].affectation.seconds);
+        free(taches[t].affectation.distancesBMU);
+        free(taches[t].texte);
+    }
+
+    free(taches);
+    free(fenetre.mesDataset);
+    fermerFlux(&lecteur);
+    libererModele(modele);
+
+    return erreur;
+}
+
+
+/**
+ * @brief Reads a sparse dataset in the libsvm format ("label index:value index:value ...").
+ *
+ * The file is mapped (`projeterFichier`) and parsed in a single pass into CSR arrays that grow
+ * geometrically. Indices start at 1 and must be strictly increasing within a line, as libsvm
+ * requires; zero values are dropped, and everything after a '#' is a comment. The label is any
+ * token and is interned in the dictionary of the dataset. A malformed line, duplicate or unsorted
+ * indices included, is skipped and counted.
+ *
+ * @param nomFichier The name of the file.
+ * @return The dataset (`nbLignes` is 0 if the file cannot be read or holds no valid line).
+ *
+ * @note The dataset must be freed with `libererDatasetCreux`.
+ */
+DatasetCreux chargerLibsvm(char * nomFichier){
+    DatasetCreux data;
+    size_t taille, position = 0;
+    const char * texte = projeterFichier(nomFichier, &taille);
+    const char * p, * fin, * saut, * debutEtiquette, * finEtiquette, * suite;
+    long capaciteLignes = 1024, capaciteNonNuls = 16384, debutLigne, indice, precedent, z;
+    int valide, nbChiffres;
+    double valeur, norme, facteur;
+
+    memset(&data, 0, sizeof(data));
+    data.dico = creerDictionnaire();
+
+    if(texte == NULL){
+        return data;
+    }
+
+    data.nbOctets = (long)taille;
+    data.debutLignes = malloc((capaciteLignes + 1) * sizeof(long));
+    data.normes = malloc(capaciteLignes * sizeof(double));
+    data.classes = malloc(capaciteLignes * sizeof(int));
+    data.colonnes = malloc(capaciteNonNuls * sizeof(int));
+    data.valeurs = malloc(capaciteNonNuls * sizeof(reel));
+    data.debutLignes[0] = 0;
+
+    while(position < taille){
+        p = texte + position;
+        saut = memchr(p, '\n', taille - position);
+        fin = (saut != NULL) ? saut : texte + taille;
+        position = (size_t)(fin - texte) + 1;
+
+        if((saut = memchr(p, '#', fin - p)) != NULL){ // commentaire
+            fin = saut;
+        }
+        while(fin > p && (fin[-1] == '\r' || fin[-1] == ' ' || fin[-1] == '\t')){
+            fin--;
+        }
+        while(p < fin && (*p == ' ' || *p == '\t')){
+            p++;
+        }
+
+        if(p == fin){ // ligne vide
+            continue;
+        }
+
+        debutEtiquette = p;
+        while(p < fin && *p != ' ' && *p != '\t'){
+            p++;
+        }
+        finEtiquette = p;
+
+        debutLigne = data.nbNonNuls;
+        norme = 0.0;
+        precedent = 0;
+        valide = 1;
+
+        while(p < fin){
+            while(p < fin && (*p == ' ' || *p == '\t')){
+                p++;
+            }
+
+            for(indice = 0, nbChiffres = 0; p < fin && *p >= '0' && *p <= '9'; p++, nbChiffres++){
+                if(indice <= INT_MAX){
+                    indice = indice * 10 + (*p - '0');
+                }
+            }
+
+            if(nbChiffres == 0 || indice <= precedent || indice > INT_MAX || p == fin || *p != ':'){ // indices croissants, a partir de 1
+                valide = 0;
+                break;
+            }
+            precedent = indice;
+
+            valeur = lireReel(p + 1, fin, &suite);
+
+            if(suite == p + 1 || (suite < fin && *suite != ' ' && *suite != '\t')){
+                valide = 0;
+                break;
+            }
+            p = suite;
+
+            if(valeur == 0.0){
+                continue;
+            }
+
+            if(data.nbNonNuls == capaciteNonNuls){
+                capaciteNonNuls *= 2;
+                data.colonnes = realloc(data.colonnes, capaciteNonNuls * sizeof(int));
+                data.valeurs = realloc(data.valeurs, capaciteNonNuls * sizeof(reel));
+            }
+
+            data.colonnes[data.nbNonNuls] = (int)(indice - 1);
+            data.valeurs[data.nbNonNuls] = valeur;
+            data.nbNonNuls++;
+            norme += valeur * valeur;
+        }
+
+        if(!valide){
+            data.nbNonNuls = debutLigne;
+            data.nbErreurs++;
+            continue;
+        }
+
+        if(data.nbLignes == capaciteLignes){
+            capaciteLignes *= 2;
+            data.debutLignes = realloc(data.debutLignes, (capaciteLignes + 1) * sizeof(long));
+            data.normes = realloc(data.normes, capaciteLignes * sizeof(double));
+            data.classes = realloc(data.classes, capaciteLignes * sizeof(int));
+        }
+
+        // normalisation de la ligne, comme les donnees denses
+        facteur = (norme > 0.0) ? 1.0 / sqrt(norme) : 0.0;
+        norme = 0.0;
+
+        for(z=debutLigne; z<data.nbNonNuls; z++){
+            data.valeurs[z] *= facteur;
+            norme += data.valeurs[z] * data.valeurs[z];
+        }
+
+        data.normes[data.nbLignes] = norme;
+        data.classes[data.nbLignes] = internerEtiquette(&data.dico, debutEtiquette, (size_t)(finEtiquette - debutEtiquette));
+        data.nbLignes++;
+        data.debutLignes[data.nbLignes] = data.nbNonNuls;
+    }
+
+    for(z=0; z<data.nbNonNuls; z++){
+        if(data.colonnes[z] >= data.tailleVec){
+            data.tailleVec = data.colonnes[z] + 1;
+        }
+    }
+
+    libererProjection(texte, taille);
+
+    return data;
+}
+
+
+/**
+ * @brief Frees a sparse dataset read by `chargerLibsvm`.
+ *
+ * @param data The dataset.
+ */
+void libererDatasetCreux(DatasetCreux data){
+    free(data.debutLignes);
+    free(data.colonnes);
+    free(data.valeurs);
+    free(data.normes);
+    free(data.classes);
+    libererDictionnaire(data.dico);
+}
+
+
+/**
+ * @brief Searches for the BMU of a sparse data point, in O(nonzeros x neurons).
+ *
+ * The codebook is stored scaled: neuron n is `echelles[n]` times its row of the weight block,
+ * and `normes[n]` holds the squared norm of the scaled vector. The squared distance is then
+ * ||w||^2 - 2 x.w + ||x||^2, where the dot product only visits the nonzeros of x. The dot
+ * products are kept in `produits` for the update (`apprentissageCreux`). Ties are broken as
+ * in `rechercheBMU`.
+ *
+ * @param dataMatrice The neuron matrix (scaled rows).
+ * @param echelles The scale of each neuron.
+ * @param data The sparse dataset.
+ * @param k The index of the data point.
+ * @param produits Output: the dot product of the data point with each neuron.
+ * @param generateur The generator of the tie-breaking draws.
+ * @return The BMU, as returned by `rechercheBMU`.
+ *
+ * @note The distances can come out slightly negative through rounding for a neuron very
+ *       close to the data point.
+ */
+BMU rechercheBMUCreux(ParamMatrice dataMatrice, const double * echelles, const DatasetCreux * data, int k, double * produits, Generateur * generateur){
+    long z, debut = data->debutLignes[k], fin = data->debutLignes[k+1];
+    int n;
+    double produit;
+    const reel * vecteur;
+    BMU bmu;
+
+    bmu.indice = -1;
+    bmu.distance = HUGE_VAL;
+    bmu.indiceSecond = -1;
+    bmu.distanceSecond = HUGE_VAL;
+    bmu.nbEgalites = 0;
+
+    for(n=0; n<dataMatrice.nbNeurone; n++){
+        vecteur = dataMatrice.poids + (size_t)n * dataMatrice.tailleVecPad;
+        produit = 0.0;
+
+        for(z=debut; z<fin; z++){
+            produit += data->valeurs[z] * vecteur[data->colonnes[z]];
+        }
+
+        produits[n] = echelles[n] * produit;
+        comparerBMU(&bmu, n, dataMatrice.normes[n] - 2.0 * produits[n] + data->normes[k], generateur);
+    }
+
+    if(dataMatrice.mesure != NULL){
+        dataMatrice.mesure->compteurs.nbRecherches++;
+        dataMatrice.mesure->compteurs.nbDistances += dataMatrice.nbNeurone;
+        dataMatrice.mesure->compteurs.nbEgalites += bmu.nbEgalites > 1;
+    }
+
+    bmu.x = bmu.indice / dataMatrice.longueur;
+    bmu.y = bmu.indice % dataMatrice.longueur;
+
+    return bmu;
+}
+
+
+/**
+ * @brief Moves the BMU of a sparse data point and its neighbors toward it, in O(nonzeros) per neuron.
+ *
+ * The update w <- (1-c) w + c x of `apprentissage` is split in two: the dense shrink (1-c) goes
+ * into the scale of the neuron, and only the nonzeros of x are added to its row, divided by the
+ * new scale. The squared norm follows from the dot product of the search:
+ * (1-c)^2 ||w||^2 + 2c(1-c) x.w + c^2 ||x||^2. A neuron whose scale leaves
+ * [ECHELLE_MIN_CREUX, 1/ECHELLE_MIN_CREUX] is brought back to a scale of 1 in O(dimension).
+ *
+ * @param bmu The BMU of the data point.
+ * @param dataMatrice The neuron matrix (scaled rows).
+ * @param echelles The scale of each neuron, updated.
+ * @param alpha The learning rate.
+ * @param voisin The neighborhood radius.
+ * @param data The sparse dataset.
+ * @param k The index of the data point.
+ * @param produits The dot products computed by `rechercheBMUCreux` for this data point.
+ */
+void apprentissageCreux(BMU bmu, ParamMatrice dataMatrice, double * echelles, double alpha, int voisin, const DatasetCreux * data, int k, const double * produits){
+    int i, j, n, d, cote;
+    int debutX, finX, debutY, finY;
+    long z, debut = data->debutLignes[k], fin = data->debutLignes[k+1];
+    double coefficient = alpha, facteur, pas;
+    reel * vecteur;
+    double * poidsVoisinage = NULL;
+
+    bornesFenetre(bmu.x, voisin, dataMatrice.largeur, &debutX, &finX);
+    bornesFenetre(bmu.y, voisin, dataMatrice.longueur, &debutY, &finY);
+    cote = 2*voisin+1;
+
+    if(dataMatrice.mesure != NULL){
+        dataMatrice.mesure->compteurs.nbMisesAJour += (long)(finX - debutX + 1) * (finY - debutY + 1);
+    }
+
+    if(dataMatrice.voisinage != VOISINAGE_BULLE && voisin <= dataMatrice.rayonTable){
+        poidsVoisinage = dataMatrice.tableVoisinage;
+
+        for(d=0; d<voisin; d++){ // saut jusqu'au bloc du rayon voisin
+            poidsVoisinage += (2*d+1) * (2*d+1);
+        }
+    }
+
+    for(i=debutX; i<=finX; i++){
+        for(j=debutY; j<=finY; j++){
+            n = i*dataMatrice.longueur + j;
+            vecteur = dataMatrice.poids + (size_t)n * dataMatrice.tailleVecPad;
+
+            if(poidsVoisinage != NULL){
+                coefficient = alpha * poidsVoisinage[(i - bmu.x + voisin)*cote + (j - bmu.y + voisin)];
+            }
+            else if(dataMatrice.voisinage != VOISINAGE_BULLE){
+                coefficient = alpha * coefficientVoisinage(dataMatrice.voisinage, i - bmu.x, j - bmu.y, voisin);
+            }
+
+            facteur = 1.0 - coefficient;
+            dataMatrice.normes[n] = facteur * facteur * dataMatrice.normes[n] + 2.0 * coefficient * facteur * produits[n]
+                                    + coefficient * coefficient * data->normes[k];
+            echelles[n] *= facteur;
+
+            if(fabs(echelles[n]) < ECHELLE_MIN_CREUX || fabs(echelles[n]) > 1.0 / ECHELLE_MIN_CREUX){ // retour a l'echelle 1
+                for(d=0; d<dataMatrice.tailleVec; d++){
+                    vecteur[d] *= echelles[n];
+                }
+                echelles[n] = 1.0;
+            }
+
+            pas = coefficient / echelles[n];
+
+            for(z=debut; z<fin; z++){
+                vecteur[data->colonnes[z]] += pas * data->valeurs[z];
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief Brings every neuron of a scaled codebook back to a scale of 1 and recomputes the norms.
+ *
+ * Called after each epoch of `entrainementCreux`, so that the rounding of the norm updates does
+ * not build up, and before the codebook is used as a plain one.
+ *
+ * @param dataMatrice The neuron matrix (scaled rows).
+ * @param echelles The scale of each neuron, set to 1.
+ */
+void materialiserCreux(ParamMatrice dataMatrice, double * echelles){
+    int n, d;
+    reel * vecteur;
+
+    for(n=0; n<dataMatrice.nbNeurone; n++){
+        if(echelles[n] != 1.0){
+            vecteur = dataMatrice.poids + (size_t)n * dataMatrice.tailleVecPad;
+
+            for(d=0; d<dataMatrice.tailleVec; d++){
+                vecteur[d] *= echelles[n];
+            }
+            echelles[n] = 1.0;
+        }
+    }
+
+    rafraichirNormes(dataMatrice, 0, dataMatrice.nbNeurone);
+}
+
+
+/**
+ * @brief Trains, labels and evaluates a map on a sparse libsvm dataset (`--sparse`).
+ *
+ * The data stays in CSR form (`chargerLibsvm`) and the codebook is kept scaled, so that a BMU
+ * search costs O(nonzeros x neurons) and an update O(nonzeros) per neuron, instead of the
+ * dimension of the data (`rechercheBMUCreux`, `apprentissageCreux`). The neurons start on data
+ * points drawn at random: a dense codebook around the mean vector would put every neuron far
+ * from every sparse point. The training follows the online rule of `rapprochement`, one
+ * shuffled pass per epoch on a single thread.
+ *
+ * A last pass labels each neuron with the majority class of the points it wins (as
+ * `etiquetageCarte`) and measures the quantization and topographic errors.
+ *
+ * @param param The run configuration.
+ * @return The exit code of the program.
+ */
+int entrainementCreux(ParamExecution param){
+    DatasetCreux data;
+    ParamMatrice dataMatrice;
+    BMU bmu;
+    Generateur generateur = creerGenerateur(param.graine);
+    Generateur tirage;
+    Instrumentation mesure = creerInstrumentation(1);
+    double * echelles, * produits;
+    int * ordre, * histogramme;
+    reel * moyenne, * vecteur;
+    int i, k, b, n, nbClasses, voisin = 1;
+    long z, nbNonVoisin = 0;
+    double alpha = param.alpha, sommeDistance = 0.0, debut = chronometre(), debutPasse;
+
+    data = chargerLibsvm(param.fichier);
+
+    if(data.nbLignes == 0){
+        printf("impossible de lire le fichier libsvm %s\n", param.fichier);
+        libererDatasetCreux(data);
+        libererInstrumentation(mesure);
+        return 1;
+    }
+    mesurerPhase(&mesure, PHASE_CHARGEMENT, debut);
+
+    if(data.nbErreurs > 0){
+        printf("attention : %ld ligne(s) mal formee(s) dans %s\n", data.nbErreurs, param.fichier);
+    }
+    printf("creux : %d lignes, %d dimensions, %ld valeurs non nulles (%.4f %%), chargees en %.3f s\n",
+           data.nbLignes, data.tailleVec, data.nbNonNuls, 100.0 * data.nbNonNuls / ((double)data.nbLignes * data.tailleVec), chronometre() - debut);
+
+    // carte initialisee sur des donnees tirees au hasard
+    debutPasse = chronometre();
+    memset(&dataMatrice, 0, sizeof(dataMatrice));
+    dataMatrice = genererMatriceNeurone(dataMatrice, (param.nbNeurone > 0) ? param.nbNeurone : 5*sqrt(data.nbLignes), data.tailleVec);
+    dataMatrice.generateur = &generateur;
+    dataMatrice = preparerTableVoisinage(dataMatrice, param.voisinage, RAYON_VOISINAGE_MAX);
+    dataMatrice.mesure = (param.fichierStats != NULL) ? &mesure : NULL;
+    echelles = malloc(dataMatrice.nbNeurone * sizeof(double));
+    produits = malloc(dataMatrice.nbNeurone * sizeof(double));
+
+    for(n=0; n<dataMatrice.nbNeurone; n++){
+        k = (int)tirerBorne(&generateur, (uint32_t)data.nbLignes);
+        vecteur = dataMatrice.poids + (size_t)n * dataMatrice.tailleVecPad;
+
+        for(z=data.debutLignes[k]; z<data.debutLignes[k+1]; z++){
+            vecteur[data.colonnes[z]] = data.valeurs[z];
+        }
+        dataMatrice.normes[n] = data.normes[k];
+        echelles[n] = 1.0;
+    }
+
+    ordre = indiceMelange(data.nbLignes, &generateur);
+    mesurerPhase(&mesure, PHASE_INITIALISATION, debutPasse);
+
+    for(i=0; i<param.temps; i++){
+        debutPasse = chronometre();
+        planningApprentissage(i, param.temps, param.alpha, &alpha, &voisin);
+        melangerIndices(ordre, data.nbLignes, &generateur);
+
+        for(b=0; b<data.nbLignes; b++){
+            k = ordre[b];
+            bmu = rechercheBMUCreux(dataMatrice, echelles, &data, k, produits, dataMatrice.generateur);
+            apprentissageCreux(bmu, dataMatrice, echelles, alpha, voisin, &data, k, produits);
+        }
+
+        materialiserCreux(dataMatrice, echelles);
+        mesurerPhase(&mesure, PHASE_APPRENTISSAGE, debutPasse);
+        noterEpoque(&mesure, chronometre() - debutPasse);
+    }
+
+    // etiquetage et erreurs, la carte n'est plus modifiee
+    debutPasse = chronometre();
+    nbClasses = (data.dico.nbNoms > 0) ? data.dico.nbNoms : 1;
+    histogramme = calloc((size_t)dataMatrice.nbNeurone * nbClasses, sizeof(int));
+
+    for(k=0; k<data.nbLignes; k++){
+        tirage = creerGenerateur(GRAINE_ETIQUETAGE + (uint64_t)k);
+        bmu = rechercheBMUCreux(dataMatrice, echelles, &data, k, produits, &tirage);
+        histogramme[(size_t)bmu.indice * nbClasses + data.classes[k]]++;
+        sommeDistance += sqrt(bmu.distance > 0.0 ? bmu.distance : 0.0);
+
+        if(bmu.indiceSecond >= 0 && (abs(bmu.x - bmu.indiceSecond / dataMatrice.longueur) > 1
+                                     || abs(bmu.y - bmu.indiceSecond % dataMatrice.longueur) > 1)){
+            nbNonVoisin++;
+        }
+    }
+
+    etiquetterHistogramme(dataMatrice, histogramme, nbClasses);
+    mesurerPhase(&mesure, PHASE_ETIQUETAGE, debutPasse);
+    printf("\n");
+    afficheEtiquette(dataMatrice, data.dico);
+
+    printf("\nerreur de quantification : %f\nerreur topographique : %f\n",
+           sommeDistance / data.nbLignes, (double)nbNonVoisin / data.nbLignes);
+
+    if(param.fichierModele != NULL){
+        debutPasse = chronometre();
+        moyenne = calloc(data.tailleVec, sizeof(reel));
+
+        for(z=0; z<data.nbNonNuls; z++){
+            moyenne[data.colonnes[z]] += data.valeurs[z] / data.nbLignes;
+        }
+
+        if(ecrireModele(dataMatrice, moyenne, data.dico, param.fichierModele) != 0){
+            printf("impossible d'ecrire %s\n", param.fichierModele);
+        }
+        else{
+            printf("modele ecrit dans %s\n", param.fichierModele);
+        }
+        free(moyenne);
+        mesurerPhase(&mesure, PHASE_MODELE, debutPasse);
+    }
+
+    if(param.fichierStats != NULL){
+        mesure.octetsCharges = data.nbOctets;
+
+        if(ecrireRapport(&mesure, param.fichierStats, "creux") != 0){
+            printf("impossible d'ecrire %s\n", param.fichierStats);
+        }
+    }
+    libererInstrumentation(mesure);
+
+    free(histogramme);
+    free(ordre);
+    free(produits);
+    free(echelles);
+    libererMatrice(dataMatrice);
+    libererDatasetCreux(data);
+
+    return 0;
+}
+
+
+/**
+ * @brief Searches for the Best Matching Unit (BMU) in a neuron matrix.
+ *
+ * This function scans the distances computed by `distanceEuclidienneMatrice` once and keeps
+ * track of the smallest and second smallest values. When several neurons share the minimum
+ * distance, one of them is chosen uniformly at random by reservoir sampling: the k-th tied
+ * neuron replaces the current choice with probability 1/k. No memory is allocated.
+ *
+ * @param dataMatrice A `ParamMatrice` structure whose `distances` array is up to date.
+ * @param generateur The generator of the tie-breaking draws.
+ *
+ * @return A `BMU` structure holding the chosen BMU, the second best neuron and the number
+ *         of neurons tied at the minimum distance.
+ *
+ * @note When the BMU is tied with other neurons, the second best neuron is one of them
+ *       (at the same distance).
+ */
+BMU rechercheBMU(ParamMatrice dataMatrice, Generateur * generateur){
+    int k;
+    BMU bmu;
+
+    bmu.indice = 0;
+    bmu.distance = dataMatrice.distances[0];
+    bmu.indiceSecond = -1;
+    bmu.distanceSecond = HUGE_VAL;
+    bmu.nbEgalites = 1;
+
+    for(k=1; k<dataMatrice.nbNeurone; k++){
+        comparerBMU(&bmu, k, dataMatrice.distances[k], generateur);
+    }
+
+    if(dataMatrice.mesure != NULL){ // distances comptees par leur calcul
+        dataMatrice.mesure->compteurs.nbRecherches++;
+        dataMatrice.mesure->compteurs.nbEgalites += bmu.nbEgalites > 1;
+    }
+
+    bmu.x = bmu.indice / dataMatrice.longueur;
+    bmu.y = bmu.indice % dataMatrice.longueur;
+
+    return bmu;
+}
+
+
+/**
+ * @brief Takes one more neuron into account in a BMU search.
+ *
+ * Keeps the smallest and second smallest distances; among neurons tied at the minimum,
+ * the k-th one replaces the current choice with probability 1/k.
+ *
+ * @param bmu The search in progress.
+ * @param k The index of the neuron.
+ * @param distance The squared distance of the neuron to the input.
+ * @param generateur The generator of the tie-breaking draws.
+ */
+void comparerBMU(BMU * bmu, int k, double distance, Generateur * generateur){
+    if(distance < bmu->distance){
+        bmu->indiceSecond = bmu->indice;
+        bmu->distanceSecond = bmu->distance;
+        bmu->indice = k;
+        bmu->distance = distance;
+        bmu->nbEgalites = 1;
+    }
+
+    else if(distance == bmu->distance){ // tirage uniforme parmi les ex aequo
+        bmu->nbEgalites++;
+
+        if(tirerBorne(generateur, bmu->nbEgalites) == 0){
+            bmu->indiceSecond = bmu->indice;
+            bmu->indice = k;
+        }
+        else{
+            bmu->indiceSecond = k;
+        }
+        bmu->distanceSecond = distance;
+    }
+
+    else if(distance < bmu->distanceSecond){
+        bmu->indiceSecond = k;
+        bmu->distanceSecond = distance;
+    }
+}
+
+
+/**
+ * @brief Searches for the BMU of a vector, computing only the distances that can matter.
+ *
+ * This fuses `distanceEuclidienneMatrice` and `rechercheBMU`: the squared distance of each
+ * neuron is accumulated `BLOC_ABANDON` dimensions at a time with the SIMD kernel of the matrix,
+ * and the neuron is abandoned as soon as the partial sum exceeds the second best distance found
+ * so far. Such a neuron can be neither the BMU nor the second best, so the result is the one of
+ * the full scan (up to the rounding of the blockwise sums), second best neuron included. The
+ * `distances` array is not written. Summing the dimensions of largest variance first (see
+ * `ordreDimensions`) makes the partial sums grow faster and neurons get abandoned earlier.
+ *
+ * @param dataMatrice The neuron matrix.
+ * @param vecteur The input vector.
+ * @param generateur The generator of the tie-breaking draws.
+ * @return The BMU, as returned by `rechercheBMU`.
+ */
+BMU rechercheBMUAbandon(ParamMatrice dataMatrice, const reel * vecteur, Generateur * generateur){
+    int k, d, longueur, nbAbandons = 0;
+    double distance;
+    const reel * poids = dataMatrice.poids;
+    BMU bmu;
+
+    bmu.indice = 0;
+    bmu.distance = dataMatrice.noyauDistance(vecteur, poids, dataMatrice.tailleVec);
+    bmu.indiceSecond = -1;
+    bmu.distanceSecond = HUGE_VAL;
+    bmu.nbEgalites = 1;
+
+    for(k=1; k<dataMatrice.nbNeurone; k++){
+        poids += dataMatrice.tailleVecPad;
+        distance = 0.0;
+
+        for(d=0; d<dataMatrice.tailleVec && distance <= bmu.distanceSecond; d+=BLOC_ABANDON){
+            longueur = (d + BLOC_ABANDON < dataMatrice.tailleVec) ? BLOC_ABANDON : dataMatrice.tailleVec - d;
+            distance += dataMatrice.noyauDistance(vecteur + d, poids + d, longueur);
+        }
+
+        if(distance <= bmu.distanceSecond){
+            comparerBMU(&bmu, k, distance, generateur);
+        }
+        else if(d < dataMatrice.tailleVec){ // abandonne avant la derniere dimension
+            nbAbandons++;
+        }
+    }
+
+    if(dataMatrice.mesure != NULL){
+        dataMatrice.mesure->compteurs.nbRecherches++;
+        dataMatrice.mesure->compteurs.nbDistances += dataMatrice.nbNeurone - nbAbandons;
+        dataMatrice.mesure->compteurs.nbAbandons += nbAbandons;
+        dataMatrice.mesure->compteurs.nbEgalites += bmu.nbEgalites > 1;
+    }
+
+    bmu.x = bmu.indice / dataMatrice.longueur;
+    bmu.y = bmu.indice % dataMatrice.longueur;
+
+    return bmu;
+}
+
+
+/**
+ * @brief Finds the BMU of a vector with the scan selected for the matrix.
+ *
+ * @param dataMatrice The neuron matrix.
+ * @param vecteur The input vector.
+ * @param generateur The generator of the tie-breaking draws.
+ * @return The BMU, as returned by `rechercheBMU`.
+ */
+BMU trouverBMU(ParamMatrice dataMatrice, reel * vecteur, Generateur * generateur){
+    if(dataMatrice.abandon){
+        return rechercheBMUAbandon(dataMatrice, vecteur, generateur);
+    }
+
+    distanceEuclidienneMatrice(vecteur, dataMatrice);
+
+    return rechercheBMU(dataMatrice, generateur);
+}
+
+
+/**
+ * @brief Orders two dimensions by decreasing variance (for `qsort`).
+ *
+ * @param a The first `VarianceDimension`.
+ * @param b The second `VarianceDimension`.
+ * @return A negative value if `a` comes first.
+ */
+int comparerVariances(const void * a, const void * b){
+    const VarianceDimension * premiere = a;
+    const VarianceDimension * seconde = b;
+
+    if(premiere->variance != seconde->variance){
+        return (premiere->variance > seconde->variance) ? -1 : 1;
+    }
+
+    return premiere->indice - seconde->indice;
+}
+
+
+/**
+ * @brief Sorts the dimensions of a dataset by decreasing variance.
+ *
+ * @param data The dataset.
+ * @return The permutation: element i is the original index of the i-th dimension to sum
+ *         (to be freed by the caller).
+ */
+int * ordreDimensions(paramDataset data){
+    int i, d;
+    double * moyenne = calloc(data.tailleVec, sizeof(double));
+    VarianceDimension * variances = calloc(data.tailleVec, sizeof(VarianceDimension));
+    int * permutation = malloc(data.tailleVec * sizeof(int));
+
+    for(i=0; i<data.tailleTab; i++){
+        for(d=0; d<data.tailleVec; d++){
+            moyenne[d] += data.mesDataset[i].vecteur[d];
+        }
+    }
+
+    for(d=0; d<data.tailleVec; d++){
+        moyenne[d] /= data.tailleTab;
+        variances[d].indice = d;
+    }
+
+    for(i=0; i<data.tailleTab; i++){
+        for(d=0; d<data.tailleVec; d++){
+            variances[d].variance += (data.mesDataset[i].vecteur[d] - moyenne[d]) * (data.mesDataset[i].vecteur[d] - moyenne[d]);
+        }
+    }
+
+    qsort(variances, data.tailleVec, sizeof(VarianceDimension), comparerVariances);
+
+    for(d=0; d<data.tailleVec; d++){
+        permutation[d] = variances[d].indice;
+    }
+
+    free(variances);
+    free(moyenne);
+
+    return permutation;
+}
+
+
+/**
+ * @brief Reorders the components of every row of a matrix.
+ *
+ * Distances are invariant by a permutation of the dimensions, so the dataset and the codebook
+ * can be permuted together for the training and put back in the original order afterwards.
+ *
+ * @param bloc The matrix (nbLignes x pas).
+ * @param nbLignes The number of rows.
+ * @param pas The row stride.
+ * @param tailleVec The number of components to reorder in each row.
+ * @param permutation Element i is the original index of the new i-th component.
+ * @param inverse 1 to undo the permutation.
+ */
+void permuterDimensions(reel * bloc, int nbLignes, int pas, int tailleVec, const int * permutation, int inverse){
+    int i, d;
+    reel * ligne;
+    reel * copie = malloc(tailleVec * sizeof(reel));
+
+    for(i=0; i<nbLignes; i++){
+        ligne = bloc + (size_t)i * pas;
+        memcpy(copie, ligne, tailleVec * sizeof(reel));
+
+        for(d=0; d<tailleVec; d++){
+            if(inverse){
+                ligne[permutation[d]] = copie[d];
+            }
+            else{
+                ligne[d] = copie[permutation[d]];
+            }
+        }
+    }
+
+    free(copie);
+}
+
+
+/**
+ * @brief Computes the neighborhood weight of a neuron relative to the BMU.
+ *
+ * The width of the Gaussian is `sigma = voisin / 2`, so the window of radius `voisin` covers
+ * two standard deviations on each side. The Mexican hat uses `sigma = voisin + 1` and is
+ * positive for d < sigma: the first ring around the BMU (diagonals included) is pulled toward
+ * the input, and only the corners of the larger windows are pushed away.
+ *
+ * @param type The shape of the neighborhood function.
+ * @param ecartX The row offset between the neuron and the BMU.
+ * @param ecartY The column offset between the neuron and the BMU.
+ * @param voisin The current neighborhood radius.
+ * @return The weight applied to the learning rate for this neuron.
+ */
+double coefficientVoisinage(typeVoisinage type, int ecartX, int ecartY, int voisin){
+    double distance2 = (double)(ecartX * ecartX + ecartY * ecartY);
+    double sigma2 = (voisin > 0) ? (voisin / 2.0) * (voisin / 2.0) : 0.25;
+
+    switch(type){
+        case VOISINAGE_GAUSSIEN:
+            return exp(-distance2 / (2.0 * sigma2));
+
+        case VOISINAGE_CHAPEAU_MEXICAIN:
+            sigma2 = (voisin + 1.0) * (voisin + 1.0);
+            return (1.0 - distance2 / sigma2) * exp(-distance2 / (2.0 * sigma2));
+
+        default:
+            return 1.0;
+    }
+}
+
+
+/**
+ * @brief Precomputes the neighborhood weights for every radius up to `rayonMax`.
+ *
+ * The weights of radius r form a (2r+1) x (2r+1) block indexed by the offset to the BMU;
+ * the blocks are stored one after the other, by increasing radius, so the block of radius r
+ * starts at the sum of (2q+1)^2 for q < r. The bubble needs no table: every weight is 1.
+ *
+ * @param dataMatrice The neuron matrix to configure (passed by value).
+ * @param type The shape of the neighborhood function.
+ * @param rayonMax The largest radius that will be used during training.
+ * @return The updated `ParamMatrice` structure.
+ *
+ * @note Radii larger than `rayonMax` still work: their weights are then computed on the fly.
+ */
+ParamMatrice preparerTableVoisinage(ParamMatrice dataMatrice, typeVoisinage type, int rayonMax){
+    int r, i, j, cote;
+    int taille = 0;
+    double * bloc;
+
+    free(dataMatrice.tableVoisinage);
+    dataMatrice.voisinage = type;
+    dataMatrice.tableVoisinage = NULL;
+    dataMatrice.rayonTable = -1;
+
+    if(type == VOISINAGE_BULLE){
+        return dataMatrice;
+    }
+
+    for(r=0; r<=rayonMax; r++){
+        taille += (2*r+1) * (2*r+1);
+    }
+
+    dataMatrice.tableVoisinage = malloc(taille * sizeof(double));
+    dataMatrice.rayonTable = rayonMax;
+    bloc = dataMatrice.tableVoisinage;
+
+    for(r=0; r<=rayonMax; r++){
+        cote = 2*r+1;
+
+        for(i=-r; i<=r; i++){
+            for(j=-r; j<=r; j++){
+                bloc[(i+r)*cote + (j+r)] = coefficientVoisinage(type, i, j, r);
+            }
+        }
+        bloc += cote * cote;
+    }
+
+    return dataMatrice;
+}
+
+
+/**
+ * @brief Performs the learning (weight update) for the BMU (Best Matching Unit) and its neighbors.
+ *
+ * This function updates the weights of the neurons of the square window of radius `voisin`
+ * centered on the BMU, clipped to the borders of the grid. Only the rows of the weight block
+ * inside that window are visited, so the cost depends on the neighborhood size and not on the
+ * size of the map. Each neuron moves toward the input vector by `alpha` times its neighborhood
+ * weight, read from the precomputed table of the matrix (1 for the bubble). The cached squared
+ * norm of each updated neuron is refreshed in the same pass, and so are its drift and its
+ * sketch when a BMU accelerator tracks them.
+ *
+ * @param bmu The BMU (Best Matching Unit) whose weights, and those of its neighbors, will be updated.
+ * @param dataMatrice The matrix of neurons to be updated.
+ * @param alpha The learning rate, which controls the size of the weight updates.
+ * @param tailleVec The dimension of the vector (i.e., the number of elements in each neuron's vector).
+ * @param voisin The radius around the BMU within which the neighbors' weights will be updated.
+ * @param dataVec The input vector to be used for the learning process.
+ */
+void apprentissage(BMU bmu, ParamMatrice dataMatrice, double alpha, int tailleVec, int voisin, reel * dataVec){
+    int i,j,k;
+    int debutX, finX, debutY, finY, cote;
+    double coefficient = alpha;
+    double norme, deplacement;
+    reel * vecteur;
+    reel * esquisseNeurone;
+    double * poidsVoisinage = NULL;
+
+    bornesFenetre(bmu.x, voisin, dataMatrice.largeur, &debutX, &finX);
+    bornesFenetre(bmu.y, voisin, dataMatrice.longueur, &debutY, &finY);
+    cote = 2*voisin+1;
+
+    if(dataMatrice.mesure != NULL){
+        dataMatrice.mesure->compteurs.nbMisesAJour += (long)(finX - debutX + 1) * (finY - debutY + 1);
+    }
+
+    if(dataMatrice.voisinage != VOISINAGE_BULLE && voisin <= dataMatrice.rayonTable){
+        poidsVoisinage = dataMatrice.tableVoisinage;
+
+        for(k=0; k<voisin; k++){ // saut jusqu'au bloc du rayon voisin
+            poidsVoisinage += (2*k+1) * (2*k+1);
+        }
+    }
+
+    for(i=debutX; i<=finX; i++){
+        vecteur = vecteurNeurone(dataMatrice, i, debutY);
+
+        for(j=debutY; j<=finY; j++){
+
+            if(poidsVoisinage != NULL){
+                coefficient = alpha * poidsVoisinage[(i - bmu.x + voisin)*cote + (j - bmu.y + voisin)];
+            }
+            else if(dataMatrice.voisinage != VOISINAGE_BULLE){
+                coefficient = alpha * coefficientVoisinage(dataMatrice.voisinage, i - bmu.x, j - bmu.y, voisin);
+            }
+
+            norme = 0.0;
+
+            for(k=0; k<tailleVec; k++){
+                vecteur[k] += coefficient * (dataVec[k] - vecteur[k]);
+                norme += vecteur[k] * vecteur[k];
+            }
+
+            if(dataMatrice.suivi != NULL){ // derive du neurone, pour les bornes de la recherche du BMU
+                deplacement = sqrt(dataMatrice.noyauDistance(vecteur, dataMatrice.suivi->reference + (vecteur - dataMatrice.poids), tailleVec));
+                dataMatrice.suivi->derive[i*dataMatrice.longueur + j] = deplacement;
+
+                if(deplacement > dataMatrice.suivi->deriveMax){
+                    dataMatrice.suivi->deriveMax = deplacement;
+                }
+            }
+
+            if(dataMatrice.esquisse != NULL){ // la projection est lineaire : l'esquisse suit le meme pas
+                esquisseNeurone = dataMatrice.esquisse->esquissesNeurones + (size_t)(i*dataMatrice.longueur + j) * dataMatrice.esquisse->dimension;
+
+                for(k=0; k<dataMatrice.esquisse->dimension; k++){
+                    esquisseNeurone[k] += coefficient * (dataMatrice.esquisse->courante[k] - esquisseNeurone[k]);
+                }
+            }
+
+            dataMatrice.normes[i*dataMatrice.longueur + j] = norme;
+            vecteur += dataMatrice.tailleVecPad;
+        }
+    }
+
+}
+
+
+/**
+ * @brief Labels the neurons from a histogram of the classes of the data points they won.
+ *
+ * Each neuron takes the majority class of its histogram (the smallest class index on a tie),
+ * its number of impacts and the share of them belonging to that class (purity). A neuron
+ * that won no data point takes the class of the nearest labelled neuron in weight space,
+ * with a purity of 0.
+ *
+ * @param dataMatrice The neuron matrix to label.
+ * @param histogramme Number of data points of each class won by each neuron (nbNeurone x nbClasses).
+ * @param nbClasses The number of classes (row size of the histogram).
+ */
+void etiquetterHistogramme(ParamMatrice dataMatrice, const int * histogramme, int nbClasses){
+    int k, c, n, meilleur;
+    double distance, plusPetite;
+
+    for(k=0; k<dataMatrice.nbNeurone; k++){
+        dataMatrice.classes[k] = -1;
+        dataMatrice.impacts[k] = 0;
+        dataMatrice.purete[k] = 0.0;
+
+        for(c=0; c<nbClasses; c++){
+            dataMatrice.impacts[k] += histogramme[(size_t)k * nbClasses + c];
+
+            if(histogramme[(size_t)k * nbClasses + c] > 0
+               && (dataMatrice.classes[k] < 0 || histogramme[(size_t)k * nbClasses + c] > histogramme[(size_t)k * nbClasses + dataMatrice.classes[k]])){
+                dataMatrice.classes[k] = c;
+            }
+        }
+
+        if(dataMatrice.impacts[k] > 0){
+            dataMatrice.purete[k] = (double)histogramme[(size_t)k * nbClasses + dataMatrice.classes[k]] / dataMatrice.impacts[k];
+        }
+    }
+
+    for(k=0; k<dataMatrice.nbNeurone; k++){ // neurones sans impact
+        if(dataMatrice.impacts[k] > 0){
+            continue;
+        }
+
+        meilleur = -1;
+        plusPetite = HUGE_VAL;
+
+        for(n=0; n<dataMatrice.nbNeurone; n++){
+            if(dataMatrice.impacts[n] == 0){
+                continue;
+            }
+
+            distance = dataMatrice.noyauDistance(dataMatrice.poids + (size_t)k * dataMatrice.tailleVecPad,
+                                                 dataMatrice.poids + (size_t)n * dataMatrice.tailleVecPad, dataMatrice.tailleVec);
+            if(distance < plusPetite){
+                plusPetite = distance;
+                meilleur = n;
+            }
+        }
+
+        dataMatrice.classes[k] = (meilleur >= 0) ? dataMatrice.classes[meilleur] : -1;
+    }
+}
+
+
+/**
+ * @brief Finds the BMU of every data point of the dataset and measures the quality of the map.
+ *
+ * The BMU and the second best neuron of every data point are found on several threads, with
+ * the same assignment step as the batch training (`batchAffectation`, mini-batch distances when
+ * `tailleLot` > 1). The map is only read.
+ *
+ * The quantization error is the mean distance between a data point and its BMU; the topographic
+ * error is the fraction of data points whose BMU and second best neuron are not adjacent on the
+ * grid (8-neighborhood). Both are summed in data order, so they do not depend on the number of threads.
+ *
+ * @param data The dataset.
+ * @param dataMatrice The neuron matrix.
+ * @param nbThreads The number of threads.
+ * @param tailleLot The mini-batch size of the BMU assignment.
+ * @param bmus Output: the BMU of each data point (tailleTab entries).
+ * @param erreurQuantification Output: the quantization error.
+ * @param erreurTopographique Output: the topographic error, between 0 and 1.
+ */
+void affectationCarte(paramDataset data, ParamMatrice dataMatrice, int nbThreads, int tailleLot, int * bmus,
+                      double * erreurQuantification, double * erreurTopographique){
+    int k, t;
+    int nbNonVoisin = 0;
+    double sommeDistance = 0.0;
+    int * seconds = malloc(data.tailleTab * sizeof(int));
+    double * distancesBMU = malloc(data.tailleTab * sizeof(double));
+    TacheBatch * taches = malloc(nbThreads * sizeof(TacheBatch));
+    Instrumentation * mesures = mesuresThreads(dataMatrice, nbThreads);
+
+    for(t=0; t<nbThreads; t++){
+        taches[t].data = data;
+        taches[t].dataMatrice = dataMatrice;
+        taches[t].dataMatrice.distances = allocAligne(dataMatrice.nbNeurone * sizeof(double));
+        taches[t].dataMatrice.mesure = (mesures != NULL) ? &mesures[t] : NULL;
+        taches[t].bmus = bmus;
+        taches[t].seconds = seconds;
+        taches[t].distancesBMU = distancesBMU;
+        taches[t].tailleLot = tailleLot;
+        taches[t].debut = (int)((long)data.tailleTab * t / nbThreads);
+        taches[t].fin = (int)((long)data.tailleTab * (t+1) / nbThreads);
+        taches[t].graine = GRAINE_ETIQUETAGE;
+    }
+
+    lancerThreads(nbThreads, batchAffectation, taches, sizeof(TacheBatch));
+    fusionnerMesures(dataMatrice, mesures, nbThreads);
+
+    for(k=0; k<data.tailleTab; k++){
+        sommeDistance += sqrt(distancesBMU[k]);
+
+        if(seconds[k] >= 0 && (abs(bmus[k] / dataMatrice.longueur - seconds[k] / dataMatrice.longueur) > 1
+                               || abs(bmus[k] % dataMatrice.longueur - seconds[k] % dataMatrice.longueur) > 1)){
+            nbNonVoisin++;
+        }
+    }
+
+    *erreurQuantification = sommeDistance / data.tailleTab;
+    *erreurTopographique = (double)nbNonVoisin / data.tailleTab;
+
+    for(t=0; t<nbThreads; t++){
+        libererAligne(taches[t].dataMatrice.distances);
+    }
+
+    free(taches);
+    free(distancesBMU);
+    free(seconds);
+}
+
+
+/**
+ * @brief Labels a trained map and measures its quality in one parallel pass over the dataset.
+ *
+ * The BMU of every data point is found by `affectationCarte`, which also measures the
+ * quantization and topographic errors. The classes of the data points won by each neuron are
+ * then counted and the map is labelled by majority (`etiquetterHistogramme`). This costs one BMU
+ * query per data point, where labelling each neuron by its nearest data point costs neurons x
+ * data points distances.
+ *
+ * @param data The dataset.
+ * @param dataMatrice The trained neuron matrix (classes, impacts and purities are written).
+ * @param nbThreads The number of threads.
+ * @param tailleLot The mini-batch size of the BMU assignment.
+ * @param erreurQuantification Output: the quantization error.
+ * @param erreurTopographique Output: the topographic error, between 0 and 1.
+ */
+void etiquetageCarte(paramDataset data, ParamMatrice dataMatrice, int nbThreads, int tailleLot, double * erreurQuantification, double * erreurTopographique){
+    int k, nbClasses = (data.dico.nbNoms > 0) ? data.dico.nbNoms : 1;
+    int * bmus = malloc(data.tailleTab * sizeof(int));
+    int * histogramme = calloc((size_t)dataMatrice.nbNeurone * nbClasses, sizeof(int));
+
+    affectationCarte(data, dataMatrice, nbThreads, tailleLot, bmus, erreurQuantification, erreurTopographique);
+
+    for(k=0; k<data.tailleTab; k++){
+        if(data.mesDataset[k].classe >= 0){
+            histogramme[(size_t)bmus[k] * nbClasses + data.mesDataset[k].classe]++;
+        }
+    }
+
+    etiquetterHistogramme(dataMatrice, histogramme, nbClasses);
+
+    free(histogramme);
+    free(bmus);
+}
+
+
+/**
+ * @brief Evaluates a mapped model on a dataset, without training or relabelling it.
+ *
+ * Every data point is assigned to its BMU by `affectationCarte`, and takes the label of that
+ * neuron. The labels are matched by name, so the dataset and the model may number their
+ * classes differently. The map of the model, the accuracy of the labels and the quantization
+ * and topographic errors are printed.
+ *
+ * @param data The dataset (normalized like the training set of the model).
+ * @param modele The model.
+ * @param nbThreads The number of threads.
+ * @param tailleLot The mini-batch size of the BMU assignment.
+ */
+void evaluerModele(paramDataset data, Modele modele, int nbThreads, int tailleLot){
+    int k, nbEtiquetees = 0, nbExactes = 0;
+    int * bmus = malloc(data.tailleTab * sizeof(int));
+    int * correspondance = malloc((data.dico.nbNoms > 0 ? data.dico.nbNoms : 1) * sizeof(int));
+    double erreurQuantification, erreurTopographique;
+    DictionnaireEtiquettes noms = creerDictionnaire();
+
+    for(k=0; k<modele.dico.nbNoms; k++){ // memes indices que le modele
+        internerEtiquette(&noms, modele.dico.noms[k], strlen(modele.dico.noms[k]));
+    }
+
+    for(k=0; k<data.dico.nbNoms; k++){ // classe du dataset -> classe du modele (-1 si inconnue)
+        correspondance[k] = internerEtiquette(&noms, data.dico.noms[k], strlen(data.dico.noms[k]));
+
+        if(correspondance[k] >= modele.dico.nbNoms){
+            correspondance[k] = -1;
+        }
+    }
+
+    affectationCarte(data, modele.carte, nbThreads, tailleLot, bmus, &erreurQuantification, &erreurTopographique);
+
+    for(k=0; k<data.tailleTab; k++){
+        if(data.mesDataset[k].classe < 0){
+            continue;
+        }
+
+        nbEtiquetees++;
+        nbExactes += (correspondance[data.mesDataset[k].classe] >= 0
+                      && modele.carte.classes[bmus[k]] == correspondance[data.mesDataset[k].classe]);
+    }
+
+    afficheEtiquette(modele.carte, modele.dico);
+
+    printf("\nexactitude des etiquettes : %f (%d donnee(s) etiquetee(s))\n", (nbEtiquetees > 0) ? (double)nbExactes / nbEtiquetees : 0.0, nbEtiquetees);
+    printf("\nerreur de quantification : %f\nerreur topographique : %f\n", erreurQuantification, erreurTopographique);
+
+    libererDictionnaire(noms);
+    free(correspondance);
+    free(bmus);
+}
+
+
+/**
+ * @brief Writes a synthetic dataset drawn from a mixture of Gaussians, in the text format.
+ *
+ * The centers are drawn uniformly in [-1, 1]^D and every data point is a center chosen uniformly
+ * plus an isotropic Gaussian noise of standard deviation 0.1 (Box-Muller). The label of a data
+ * point is the index of its component ("g0", "g1" ...). The draws come from a generator of the given
+ * seed, so the same arguments always give the same file.
+ *
+ * @param nomFichier The name of the file to create.
+ * @param nbLignes The number of data points.
+ * @param tailleVec The dimension of the data points.
+ * @param nbComposantes The number of Gaussian components.
+ * @param graine The seed of the draws.
+ * @return 0 on success, -1 if the file could not be written.
+ */
+int genererMelange(char * nomFichier, int nbLignes, int tailleVec, int nbComposantes, uint64_t graine){
+    FILE * fichier = fopen(nomFichier, "w");
+    Generateur generateur = creerGenerateur(graine);
+    double * centres;
+    double u, v;
+    int k, d, composante, erreur = 0;
+
+    if(fichier == NULL){
+        return -1;
+    }
+
+    centres = malloc((size_t)nbComposantes * tailleVec * sizeof(double));
+
+    for(k=0; k<nbComposantes*tailleVec; k++){
+        centres[k] = 2.0 * tirerUniforme(&generateur) - 1.0;
+    }
+
+    for(k=0; k<nbLignes; k++){
+        composante = (int)tirerBorne(&generateur, (uint32_t)nbComposantes);
+
+        for(d=0; d<tailleVec; d++){
+            u = 1.0 - tirerUniforme(&generateur); // dans ]0, 1] pour le logarithme
+            v = tirerUniforme(&generateur);
+            fprintf(fichier, "%.5f,", centres[(size_t)composante * tailleVec + d] + 0.1 * sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v));
+        }
+        fprintf(fichier, "g%d\n", composante);
+    }
+
+    erreur |= fclose(fichier) != 0;
+    free(centres);
+
+    return erreur ? -1 : 0;
+}
+
+
+/**
+ * @brief Runs the benchmark over every combination of the benchmark lists.
+ *
+ * For each number of data points and dimension, a Gaussian mixture is written to a temporary
+ * text file (`genererMelange`). Each combination of map size, number of epochs and number of
+ * threads then goes through the whole pipeline, every phase being timed on its own: loading
+ * (`traitementFichier`), normalization, training (`rapprochement` or `entrainementBatch`, with
+ * the training options of the command line), labelling (`etiquetageCarte`) and projection of the
+ * file onto the saved model (`projectionFlux`). One CSV line per combination is appended to
+ * `param.fichierBench`; the program messages still go to the standard output.
+ *
+ * @param param The run configuration.
+ * @return The exit code of the program.
+ */
+int benchmark(ParamExecution param){
+    paramDataset data;
+    ParamMatrice dataMatrice;
+    ParamExecution projection = param;
+    FILE * resultats = fopen(param.fichierBench, "w");
+    char fichierDonnees[64], fichierModele[64], fichierSortie[64];
+    int l, d, n, e, t, erreur = 0;
+    double debut, chargement, normalisation, entrainement, etiquetage, projete;
+    double erreurQuantification, erreurTopographique;
+    Generateur generateur;
+
+    if(resultats == NULL){
+        printf("impossible d'ecrire %s\n", param.fichierBench);
+        return 1;
+    }
+
+    snprintf(fichierDonnees, sizeof(fichierDonnees), "som-bench-%d.csv", (int)getpid());
+    snprintf(fichierModele, sizeof(fichierModele), "som-bench-%d.somm", (int)getpid());
+    snprintf(fichierSortie, sizeof(fichierSortie), "som-bench-%d.out", (int)getpid());
+    projection.fichier = fichierDonnees;
+    projection.delimiteur = ",";
+    projection.modele = fichierModele;
+    projection.sortieProjection = fichierSortie;
+    projection.fichierStats = NULL;
+
+    fprintf(resultats, "lignes,dimensions,neurones,epoques,threads,mode,chargement_s,normalisation_s,apprentissage_s,"
+                       "etiquetage_s,projection_s,apprentissage_donnees_par_s,projection_donnees_par_s,erreur_quantification\n");
+
+    for(l=0; l<param.benchLignes.nb && !erreur; l++){
+        for(d=0; d<param.benchDimensions.nb && !erreur; d++){
+
+            if(genererMelange(fichierDonnees, param.benchLignes.valeurs[l], param.benchDimensions.valeurs[d], NB_GAUSSIENNES_BENCH, param.graine) != 0){
+                printf("impossible d'ecrire %s\n", fichierDonnees);
+                erreur = 1;
+                break;
+            }
+
+            for(n=0; n<param.benchNeurones.nb && !erreur; n++){
+                for(e=0; e<param.benchEpoques.nb && !erreur; e++){
+                    for(t=0; t<param.benchThreads.nb && !erreur; t++){
+                        debut = chronometre();
+                        data = traitementFichier(fichierDonnees, ",", param.benchThreads.valeurs[t]);
+                        chargement = chronometre() - debut;
+
+                        if(data.tailleTab == 0){
+                            erreur = 1;
+                            break;
+                        }
+
+                        debut = chronometre();
+                        NormaliserVecteur(data.mesDataset, data.tailleVec, data.tailleTab);
+                        data.normalise = 1;
+                        normalisation = chronometre() - debut;
+
+                        vecteurMoyen(data.mesDataset, data.tailleVec, data.tailleTab, data.vecteurMoyen);
+                        generateur = creerGenerateur(param.graine); // memes tirages pour toutes les mesures
+                        memset(&dataMatrice, 0, sizeof(dataMatrice));
+                        dataMatrice = genererMatriceNeurone(dataMatrice, param.benchNeurones.valeurs[n], data.tailleVec);
+                        dataMatrice.generateur = &generateur;
+                        genereVecteurDouble(dataMatrice, 0.3, 0.3, data.vecteurMoyen);
+                        dataMatrice = preparerTableVoisinage(dataMatrice, param.voisinage, RAYON_VOISINAGE_MAX);
+                        data.tabMelanger = indiceMelange(data.tailleTab, &generateur);
+                        dataMatrice.abandon = param.abandon;
+
+                        debut = chronometre();
+                        if(param.batch){
+                            entrainementBatch(data, dataMatrice, param.benchEpoques.valeurs[e], param.benchThreads.valeurs[t], param.tailleLot);
+                        }
+                        else if(param.hogwild){
+                            entrainementHogwild(data, dataMatrice, param.alpha, param.benchEpoques.valeurs[e], param.benchThreads.valeurs[t]);
+                        }
+                        else{
+                            rapprochement(data, dataMatrice, param.alpha, param.benchEpoques.valeurs[e], param.tailleLot, param.rayonLocal,
+                                          param.triangle, param.dimensionEsquisse, param.nbCandidats);
+                        }
+                        entrainement = chronometre() - debut;
+
+                        debut = chronometre();
+                        etiquetageCarte(data, dataMatrice, param.benchThreads.valeurs[t], param.tailleLot, &erreurQuantification, &erreurTopographique);
+                        etiquetage = chronometre() - debut;
+
+                        erreur |= ecrireModele(dataMatrice, data.vecteurMoyen, data.dico, fichierModele) != 0;
+                        projection.nbThreads = param.benchThreads.valeurs[t];
+                        debut = chronometre();
+                        erreur |= !erreur && projectionFlux(projection) != 0;
+                        projete = chronometre() - debut;
+
+                        fprintf(resultats, "%d,%d,%d,%d,%d,%s,%.6f,%.6f,%.6f,%.6f,%.6f,%.0f,%.0f,%.6f\n",
+                                data.tailleTab, data.tailleVec, dataMatrice.nbNeurone, param.benchEpoques.valeurs[e],
+                                param.benchThreads.valeurs[t], param.batch ? "batch" : (param.hogwild ? "hogwild" : "online"), chargement, normalisation,
+                                entrainement, etiquetage, projete,
+                                (entrainement > 0.0) ? (double)data.tailleTab * param.benchEpoques.valeurs[e] / entrainement : 0.0,
+                                (projete > 0.0) ? data.tailleTab / projete : 0.0, erreurQuantification);
+                        fflush(resultats);
+
+                        freeAll(data, dataMatrice);
+                    }
+                }
+            }
+        }
+    }
+
+    erreur |= fclose(resultats) != 0;
+    remove(fichierDonnees);
+    remove(fichierModele);
+    remove(fichierSortie);
+
+    if(erreur){
+        printf("benchmark interrompu\n");
+    }
+    else{
+        printf("resultats du benchmark dans %s\n", param.fichierBench);
+    }
+
+    return erreur;
+}
+
+
+/**
+ * @brief Takes the next configuration of a worker of the sweep.
+ *
+ * The worker first takes the most expensive configuration left in its own queue; when the
+ * queue is empty, it steals the cheapest configuration of the next non-empty queue, so the
+ * expensive configurations start early and the cheap ones fill the end of the sweep.
+ *
+ * @param files The queues of all the workers.
+ * @param nbFiles The number of queues.
+ * @param numero The index of the worker.
+ * @param vol Set to 1 if the configuration was stolen, 0 otherwise.
+ * @return The index of the configuration, or -1 when all the queues are empty.
+ */
+int prendreTravail(FileTravail * files, int nbFiles, int numero, int * vol){
+    int k, victime, indice = -1;
+
+    pthread_mutex_lock(&files[numero].verrou);
+    if(files[numero].debut < files[numero].fin){
+        indice = files[numero].indices[--files[numero].fin];
+    }
+    pthread_mutex_unlock(&files[numero].verrou);
+
+    *vol = 0;
+
+    for(k=1; k<nbFiles && indice < 0; k++){
+        victime = (numero + k) % nbFiles;
+
+        pthread_mutex_lock(&files[victime].verrou);
+        if(files[victime].debut < files[victime].fin){
+            indice = files[victime].indices[files[victime].debut++];
+            *vol = 1;
+        }
+        pthread_mutex_unlock(&files[victime].verrou);
+    }
+
+    return indice;
+}
+
+
+/**
+ * @brief Trains and evaluates one map configuration of the sweep.
+ *
+ * The map gets its own codebook and shuffle order; the dataset is only read. Every
+ * configuration starts from the same seed, so the configurations differ only by their
+ * hyperparameters. The training is single-threaded: the sweep runs one configuration
+ * per core.
+ *
+ * @param data The dataset, normalized and with its mean vector.
+ * @param param The run configuration (training rule and BMU search options).
+ * @param configuration The configuration, whose results are filled.
+ */
+void executerConfiguration(paramDataset data, ParamExecution param, ConfigurationBalayage * configuration){
+    ParamMatrice dataMatrice;
+    Generateur generateur = creerGenerateur(param.graine);
+    double debut = chronometre();
+    int nbNeurone = (configuration->nbNeurone > 0) ? configuration->nbNeurone : 5*sqrt(data.tailleTab);
+
+    memset(&dataMatrice, 0, sizeof(dataMatrice));
+    dataMatrice = genererMatriceNeurone(dataMatrice, nbNeurone, data.tailleVec);
+    dataMatrice.generateur = &generateur;
+    genereVecteurDouble(dataMatrice, 0.3, 0.3, data.vecteurMoyen);
+    dataMatrice = preparerTableVoisinage(dataMatrice, param.voisinage, RAYON_VOISINAGE_MAX);
+    dataMatrice.abandon = param.abandon;
+    data.tabMelanger = indiceMelange(data.tailleTab, &generateur);
+
+    if(param.batch){
+        entrainementBatch(data, dataMatrice, configuration->temps, 1, param.tailleLot);
+    }
+    else{
+        rapprochement(data, dataMatrice, configuration->alpha, configuration->temps, param.tailleLot, param.rayonLocal,
+                      param.triangle, param.dimensionEsquisse, param.nbCandidats);
+    }
+
+    etiquetageCarte(data, dataMatrice, 1, param.tailleLot, &configuration->erreurQuantification, &configuration->erreurTopographique);
+    configuration->nbNeuroneCarte = dataMatrice.nbNeurone;
+    configuration->duree = chronometre() - debut;
+
+    free(data.tabMelanger);
+    libererMatrice(dataMatrice);
+}
+
+
+/**
+ * @brief Worker thread of the sweep: trains configurations until all the queues are empty.
+ *
+ * @param arg A pointer to the `OuvrierBalayage` of the thread.
+ * @return NULL.
+ */
+void * ouvrierBalayage(void * arg){
+    OuvrierBalayage * ouvrier = arg;
+    int indice, vol;
+
+    while((indice = prendreTravail(ouvrier->files, ouvrier->nbOuvriers, ouvrier->numero, &vol)) >= 0){
+        executerConfiguration(ouvrier->data, ouvrier->param, &ouvrier->configurations[indice]);
+        ouvrier->configurations[indice].ouvrier = ouvrier->numero;
+        ouvrier->nbTaches++;
+        ouvrier->nbVols += vol;
+    }
+
+    return NULL;
+}
+
+
+/**
+ * @brief Orders two configurations of the sweep by increasing quantization error (for `qsort`).
+ *
+ * @param a The first configuration.
+ * @param b The second configuration.
+ * @return A negative, zero or positive value, as for `qsort`.
+ */
+int comparerQuantification(const void * a, const void * b){
+    double ea = ((const ConfigurationBalayage*)a)->erreurQuantification;
+    double eb = ((const ConfigurationBalayage*)b)->erreurQuantification;
+
+    return (ea > eb) - (ea < eb);
+}
+
+
+/**
+ * @brief Orders two configurations of the sweep by increasing topographic error (for `qsort`).
+ *
+ * @param a The first configuration.
+ * @param b The second configuration.
+ * @return A negative, zero or positive value, as for `qsort`.
+ */
+int comparerTopographique(const void * a, const void * b){
+    double ea = ((const ConfigurationBalayage*)a)->erreurTopographique;
+    double eb = ((const ConfigurationBalayage*)b)->erreurTopographique;
+
+    return (ea > eb) - (ea < eb);
+}
+
+
+/**
+ * @brief Orders two configurations of the sweep by increasing sum of their two ranks,
+ *        then by quantization error (for `qsort`).
+ *
+ * @param a The first configuration.
+ * @param b The second configuration.
+ * @return A negative, zero or positive value, as for `qsort`.
+ */
+int comparerRangs(const void * a, const void * b){
+    const ConfigurationBalayage * ca = a;
+    const ConfigurationBalayage * cb = b;
+    int ra = ca->rangQuantification + ca->rangTopographique;
+    int rb = cb->rangQuantification + cb->rangTopographique;
+
+    if(ra != rb){
+        return ra - rb;
+    }
+
+    return comparerQuantification(a, b);
+}
+
+
+/**
+ * @brief Trains every combination of the sweep lists on one loaded dataset, and ranks them.
+ *
+ * The dataset is loaded and normalized once by the caller and shared read only by all the
+ * threads (a binary dataset stays in its read-only mapping). The configurations are sorted by
+ * estimated cost (epochs x neurons) and dealt to one queue per thread; each thread trains the
+ * configurations of its queue and then steals from the others (`prendreTravail`), so every core
+ * stays busy until the end. The configurations are ranked separately by quantization and by
+ * topographic error (equal errors share a rank) and ordered by the sum of the two ranks.
+ *
+ * @param data The dataset, normalized and with its mean vector.
+ * @param param The run configuration: the sweep lists, the number of threads and the training options.
+ * @return 0 on success, 1 if the results could not be written.
+ */
+int balayage(paramDataset data, ParamExecution param){
+    int nbConfigurations = param.balayageAlpha.nb * param.balayageEpoques.nb * param.balayageNeurones.nb;
+    ConfigurationBalayage * configurations = malloc(nbConfigurations * sizeof(ConfigurationBalayage));
+    double * couts = malloc(nbConfigurations * sizeof(double));
+    int * ordre = malloc(nbConfigurations * sizeof(int));
+    int nbOuvriers = (param.nbThreads < nbConfigurations) ? param.nbThreads : nbConfigurations;
+    FileTravail * files = malloc(nbOuvriers * sizeof(FileTravail));
+    OuvrierBalayage * ouvriers = malloc(nbOuvriers * sizeof(OuvrierBalayage));
+    FILE * resultats;
+    int a, e, n, k, t, tmp, nbVols = 0, erreur = 0;
+    double debut = chronometre();
+
+    k = 0;
+    for(a=0; a<param.balayageAlpha.nb; a++){
+        for(e=0; e<param.balayageEpoques.nb; e++){
+            for(n=0; n<param.balayageNeurones.nb; n++){
+                configurations[k].alpha = param.balayageAlpha.valeurs[a];
+                configurations[k].temps = param.balayageEpoques.valeurs[e];
+                configurations[k].nbNeurone = param.balayageNeurones.valeurs[n];
+                couts[k] = (double)configurations[k].temps
+                           * ((configurations[k].nbNeurone > 0) ? configurations[k].nbNeurone : 5*sqrt(data.tailleTab));
+                ordre[k] = k;
+                k++;
+            }
+        }
+    }
+
+    for(k=1; k<nbConfigurations; k++){ // tri par insertion des couts croissants
+        for(t=k; t>0 && couts[ordre[t-1]] > couts[ordre[t]]; t--){
+            tmp = ordre[t];
+            ordre[t] = ordre[t-1];
+            ordre[t-1] = tmp;
+        }
+    }
+
+    for(t=0; t<nbOuvriers; t++){
+        pthread_mutex_init(&files[t].verrou, NULL);
+        files[t].indices = malloc(nbConfigurations * sizeof(int));
+        files[t].debut = 0;
+        files[t].fin = 0;
+        ouvriers[t].data = data;
+        ouvriers[t].param = param;
+        ouvriers[t].configurations = configurations;
+        ouvriers[t].files = files;
+        ouvriers[t].nbOuvriers = nbOuvriers;
+        ouvriers[t].numero = t;
+        ouvriers[t].nbTaches = 0;
+        ouvriers[t].nbVols = 0;
+    }
+
+    for(k=0; k<nbConfigurations; k++){ // distribution tournante, chaque file reste triee
+        t = k % nbOuvriers;
+        files[t].indices[files[t].fin++] = ordre[k];
+    }
 
-            }
-                indexBMU = indexPetitTab(tab, data.tailleTab);
+    lancerThreads(nbOuvriers, ouvrierBalayage, ouvriers, sizeof(OuvrierBalayage));
+
+    qsort(configurations, nbConfigurations, sizeof(ConfigurationBalayage), comparerQuantification);
+    for(k=0; k<nbConfigurations; k++){
+        configurations[k].rangQuantification = (k > 0 && configurations[k].erreurQuantification == configurations[k-1].erreurQuantification)
+                                               ? configurations[k-1].rangQuantification : k+1;
+    }
+
+    qsort(configurations, nbConfigurations, sizeof(ConfigurationBalayage), comparerTopographique);
+    for(k=0; k<nbConfigurations; k++){
+        configurations[k].rangTopographique = (k > 0 && configurations[k].erreurTopographique == configurations[k-1].erreurTopographique)
+                                              ? configurations[k-1].rangTopographique : k+1;
+    }
+
+    qsort(configurations, nbConfigurations, sizeof(ConfigurationBalayage), comparerRangs);
+
+    for(t=0; t<nbOuvriers; t++){
+        nbVols += ouvriers[t].nbVols;
+    }
+
+    printf("balayage : %d configuration(s) sur %d thread(s) en %.2f s, %d vol(s) de travail\n\n",
+           nbConfigurations, nbOuvriers, chronometre() - debut, nbVols);
+    printf("rang    alpha  epoques  neurones  erreur_q  erreur_t   duree_s\n");
+
+    for(k=0; k<nbConfigurations; k++){
+        printf("%4d  %7.4f  %7d  %8d  %8.6f  %8.6f  %8.3f\n", k+1, configurations[k].alpha, configurations[k].temps,
+               configurations[k].nbNeuroneCarte, configurations[k].erreurQuantification, configurations[k].erreurTopographique,
+               configurations[k].duree);
+    }
 
-                dataMatrice.matrice[i][j].etiquette = data.mesDataset[indexBMU].etiquette;
+    resultats = fopen(param.fichierBalayage, "w");
+
+    if(resultats == NULL){
+        printf("impossible d'ecrire %s\n", param.fichierBalayage);
+        erreur = 1;
+    }
+    else{
+        fprintf(resultats, "rang,alpha,epoques,neurones,erreur_quantification,erreur_topographique,"
+                           "rang_quantification,rang_topographique,duree_s,thread\n");
+
+        for(k=0; k<nbConfigurations; k++){
+            fprintf(resultats, "%d,%g,%d,%d,%.6f,%.6f,%d,%d,%.6f,%d\n", k+1, configurations[k].alpha, configurations[k].temps,
+                    configurations[k].nbNeuroneCarte, configurations[k].erreurQuantification, configurations[k].erreurTopographique,
+                    configurations[k].rangQuantification, configurations[k].rangTopographique, configurations[k].duree,
+                    configurations[k].ouvrier);
         }
+
+        erreur |= fclose(resultats) != 0;
+        printf("\nresultats du balayage dans %s\n", param.fichierBalayage);
     }
 
+    for(t=0; t<nbOuvriers; t++){
+        pthread_mutex_destroy(&files[t].verrou);
+        free(files[t].indices);
+    }
+
+    free(ouvriers);
+    free(files);
+    free(ordre);
+    free(couts);
+    free(configurations);
+
+    return erreur;
 }
 
+
 /**
- * @brief Finds the index of the smallest value in an array of doubles.
- *
- * This function iterates through the array and identifies the smallest value, 
- * returning the index of that value. The index of the first occurrence of the 
- * smallest value is returned in case of multiple occurrences.
+ * @brief Displays the labels of a neural network matrix.
  *
- * @param tab The array of doubles to search through.
- * @param tailleTab The size of the array.
+ * A legend first associates a short symbol with each class of the dictionary: a letter
+ * (a-z then A-Z), or the class index when there are more than 52 classes. The symbol of
+ * each neuron is then displayed row by row, separated by a delimiter (`|`), and a separator
+ * line is printed after each row for readability. A neuron without class is shown as `?`.
+ * The purity of the labels (share of the data points belonging to the class of their BMU)
+ * and the number of neurons that won no data point come last.
  *
- * @return The index of the smallest value in the array.
+ * @param dataMatrice The matrix containing the neurons with their respective classes.
+ * @param dico The label dictionary the classes refer to.
  */
-int indexPetitTab(double tab[], int tailleTab){
-    int i;
-    int indexPetit = 0;
-    double min = tab[0];
+void afficheEtiquette(ParamMatrice dataMatrice, DictionnaireEtiquettes dico){
+
+ int i,j,classe;
+ int lettres = dico.nbNoms <= 52;
+ int sansImpact = 0;
+ double impacts = 0.0, majoritaires = 0.0;
+
+    for(i=0; i<dico.nbNoms; i++){
+        if(lettres){
+            printf("%c = %s  ", (i < 26) ? 'a' + i : 'A' + i - 26, dico.noms[i]);
+        }
+        else{
+            printf("%d = %s  ", i, dico.noms[i]);
+        }
+    }
+    printf("\n\n");
+
+    for(i=0; i<dataMatrice.largeur; i++){
+        for(j=0; j<dataMatrice.longueur; j++){
+                classe = dataMatrice.classes[i*dataMatrice.longueur + j];
 
-    for(i=1; i<tailleTab; i++){
-        if(tab[i]<min){
-            indexPetit = i;
-            min =tab[i];
+                if(classe < 0){
+                    printf("? | ");
+                }
+                else if(lettres){
+                    printf("%c | ", (classe < 26) ? 'a' + classe : 'A' + classe - 26);
+                }
+                else{
+                    printf("%d | ", classe);
+                }
+            }
+            printf("\n---------------------------------------\n");
+        }
+
+    for(i=0; i<dataMatrice.nbNeurone; i++){
+        if(dataMatrice.impacts[i] == 0){
+            sansImpact++;
         }
+        impacts += dataMatrice.impacts[i];
+        majoritaires += dataMatrice.purete[i] * dataMatrice.impacts[i];
     }
 
-    return indexPetit;
+    printf("\npurete des etiquettes : %f (%d neurone(s) sans impact sur %d)\n",
+           (impacts > 0) ? majoritaires / impacts : 0.0, sansImpact, dataMatrice.nbNeurone);
 }
 
 
 /**
- * @brief Shortens the labels (etiquettes) in the neuron matrix.
+ * @brief Frees the codebook of a neuron matrix and its parallel arrays.
  *
- * This function modifies the labels (etiquettes) in the neuron matrix by
- * replacing full species names with shorter representations:
- * - "Iris-virginica" is replaced with 'a'
- * - "Iris-versicolor" is replaced with 'b'
- * - "Iris-setosa" is replaced with 'c'
+ * @param dataMatrice The matrix of neurons.
+ */
+void libererMatrice(ParamMatrice dataMatrice){
+    free(dataMatrice.classes);
+    free(dataMatrice.impacts);
+    free(dataMatrice.purete);
+    free(dataMatrice.tableVoisinage);
+    libererAligne(dataMatrice.normes);
+    libererAligne(dataMatrice.distances);
+    libererAligne(dataMatrice.poids);
+}
+
+
+/**
+ * @brief Frees all dynamically allocated memory for the dataset and neural network matrix.
  *
- * It uses dynamic memory allocation to adjust the size of the label strings.
+ * This function is responsible for releasing all dynamically allocated memory used by the dataset and
+ * the neural network matrix. It frees the memory for the mixed indices array (`tabMelanger`), the mean vector (`vecteurMoyen`),
+ * the feature matrix and the label dictionary of the dataset. It also frees the codebook block and its parallel arrays.
+ * The function ensures that all memory is properly freed to avoid memory leaks.
  *
- * @param dataMatrice The matrix of neurons whose labels need to be shortened.
+ * @param data The dataset containing all the data structures that need to be freed.
+ * @param dataMatrice The matrix of neurons, including vectors and labels, that needs to be freed.
  */
-void raccourciEtiquette(ParamMatrice dataMatrice){
-    int i,j;
+void freeAll(paramDataset data, ParamMatrice dataMatrice){
+    free(data.tabMelanger);
+    free(data.vecteurMoyen);
 
-    for(i=0; i<dataMatrice.largeur; i++){
-        for(j=0; j<dataMatrice.longueur; j++){
+// free dataset
+    if(data.projection != NULL){ // vecteurs dans le fichier projete
+        libererProjection(data.projection, data.tailleProjection);
+    }
+    else{
+        libererAligne(data.donnees);
+    }
 
+    free(data.mesDataset);
+    libererDictionnaire(data.dico);
 
+// free matrice
+    libererMatrice(dataMatrice);
+}
 
-            if(equals(dataMatrice.matrice[i][j].etiquette,"Iris-virginica")==0){
-                dataMatrice.matrice[i][j].etiquette = realloc(dataMatrice.matrice[i][j].etiquette, sizeof(char)*2);
-                dataMatrice.matrice[i][j].etiquette[0] = 'a';
-                dataMatrice.matrice[i][j].etiquette[1] = '\0';
 
-            }
 
-            if(equals(dataMatrice.matrice[i][j].etiquette,"Iris-versicolor")==0){
-                dataMatrice.matrice[i][j].etiquette = realloc(dataMatrice.matrice[i][j].etiquette, sizeof(char)*2);
-                dataMatrice.matrice[i][j].etiquette[0] = 'b';
-                dataMatrice.matrice[i][j].etiquette[1] = '\0';
-            }
 
-            if(equals(dataMatrice.matrice[i][j].etiquette,"Iris-setosa")==0){
-                dataMatrice.matrice[i][j].etiquette = realloc(dataMatrice.matrice[i][j].etiquette, sizeof(char)*2);
-                dataMatrice.matrice[i][j].etiquette[0] = 'c';
-                dataMatrice.matrice[i][j].etiquette[1] = '\0';
-            }
 
+/**
+ * @brief Reads a comma-separated list of positive integers ("1000,10000").
+ *
+ * Values beyond `TAILLE_LISTE_MAX` are ignored; values below 1 are raised to 1.
+ *
+ * @param texte The option value.
+ * @return The list.
+ */
+ListeEntiers lireListe(char * texte){
+    ListeEntiers liste;
+    char * suite;
+
+    liste.nb = 0;
+
+    while(*texte != '\0' && liste.nb < TAILLE_LISTE_MAX){
+        liste.valeurs[liste.nb] = (int)strtol(texte, &suite, 10);
+
+        if(suite == texte){
+            break;
         }
 
+        if(liste.valeurs[liste.nb] < 1){
+            liste.valeurs[liste.nb] = 1;
+        }
+        liste.nb++;
+        texte = (*suite == ',') ? suite + 1 : suite;
     }
 
-    printf("a = virginica  b = versicolor  c = setosa\n\n");
+    return liste;
 }
 
 
 /**
- * @brief Compares two strings and checks if they are equal.
- *
- * This function compares two strings character by character and returns:
- * - 0 if the strings are equal.
- * - 1 if the strings are not equal.
+ * @brief Reads a comma-separated list of real numbers ("0.3,0.7").
  *
- * The comparison stops as soon as a difference is found or when the end of either string is reached.
+ * Values beyond `TAILLE_LISTE_MAX` are ignored.
  *
- * @param mot1 The first string to compare.
- * @param mot2 The second string to compare.
- * 
- * @return 0 if the strings are equal, 1 if they are not equal.
+ * @param texte The option value.
+ * @return The list.
  */
-int equals(char* mot1, char* mot2){
-    int result = 0;
-    int i = 0;
+ListeReels lireListeReels(char * texte){
+    ListeReels liste;
+    char * suite;
+
+    liste.nb = 0;
 
-    while( mot1[i]!='\0' && mot2[i]!='\0' && result == 0){
+    while(*texte != '\0' && liste.nb < TAILLE_LISTE_MAX){
+        liste.valeurs[liste.nb] = strtod(texte, &suite);
 
-        if(mot1[i]!=mot2[i]){
-            result = 1;
+        if(suite == texte){
+            break;
         }
-        i++;
+        liste.nb++;
+        texte = (*suite == ',') ? suite + 1 : suite;
     }
 
-    return result;
+    return liste;
 }
 
 
 /**
- * @brief Displays the labels of a neural network matrix.
+ * @brief Prints the command line usage of the program.
  *
- * This function iterates over the neural network matrix and prints the label (`etiquette`) of each neuron.
- * The labels are displayed row by row, separated by a delimiter (`|`), and a separator line is printed
- * after each row for readability.
- *
- * @param dataMatrice The matrix containing the neurons with their respective labels.
+ * @param programme The name of the executable (argv[0]).
  */
-void afficheEtiquette(ParamMatrice dataMatrice){
-
- int i,j;
-
-    for(i=0; i<dataMatrice.largeur; i++){
-        for(j=0; j<dataMatrice.longueur; j++){
-                printf("%s | ", dataMatrice.matrice[i][j].etiquette);
-            }
-            printf("\n---------------------------------------\n");
-        }
+void afficherUsage(char * programme){
+    printf("usage : %s [options]\n", programme);
+    printf("  --data FICHIER         fichier de donnees (defaut iris.data)\n");
+    printf("  --delimiter C          separateur des colonnes (defaut ,)\n");
+    printf("  --alpha A              taux d'apprentissage initial (defaut 0.7)\n");
+    printf("  --epochs N             nombre d'epoques (defaut 500)\n");
+    printf("  --neighborhood TYPE    bubble, gaussian ou mexican-hat (defaut bubble)\n");
+    printf("  --mode MODE            online ou batch (defaut online)\n");
+    printf("  --minibatch B          nombre de donnees dont les distances sont calculees ensemble (defaut 1)\n");
+    printf("  --convert FICHIER      ecrit le dataset normalise au format binaire puis quitte\n");
+    printf("  --save-model FICHIER   ecrit la carte entrainee et etiquetee dans un fichier modele\n");
+    printf("  --model FICHIER        evalue un modele deja entraine sur les donnees, sans apprentissage\n");
+    printf("  --project SORTIE       avec --model : ecrit x,y,distance,etiquette pour chaque ligne des donnees, en flux (- : sortie standard)\n");
+    printf("  --neurons N            nombre de neurones de la carte (defaut 5 * racine du nombre de donnees)\n");
+    printf("  --stream               apprentissage en flux, memoire constante (--data - pour l'entree standard, avec --neurons)\n");
+    printf("  --window W             nombre de donnees par fenetre du mode flux (defaut 4096)\n");
+    printf("  --sparse               --data est un fichier libsvm creux (etiquette indice:valeur ...), distances sur les valeurs non nulles\n");
+    printf("  --local-search R       recherche du BMU autour du precedent, rayon R (defaut 0 : parcours complet)\n");
+    printf("  --early-abandon        recherche du BMU avec abandon des neurones des que la distance partielle est trop grande\n");
+    printf("  --sort-dimensions      comme --early-abandon, dimensions de plus forte variance sommees en premier\n");
+    printf("  --triangle             elagage exact de la recherche du BMU par l'inegalite triangulaire (regle en ligne)\n");
+    printf("  --sketch M             recherche du BMU en deux temps sur des projections aleatoires de dimension M (approchee, regle en ligne)\n");
+    printf("  --candidates K         nombre de candidats de --sketch recalcules en pleine dimension (defaut 16)\n");
+    printf("  --hogwild              regle en ligne sur --threads threads partageant la carte sans verrou\n");
+    printf("  --processes P          regle batch sur P processus, chacun sur une part des donnees, accumulateurs reduits a chaque epoque\n");
+    printf("  --transport T          reduction de --processes : shm (memoire partagee, defaut) ou socket (sockets Unix)\n");
+    printf("  --hogwild-check        comme --hogwild, compare l'erreur de quantification a celle d'un apprentissage a 1 thread\n");
+    printf("  --stats FICHIER        ecrit a la fin un rapport JSON : temps par phase et par epoque, compteurs, memoire\n");
+    printf("  --bench FICHIER        benchmark sur des melanges de gaussiennes, resultats CSV dans FICHIER\n");
+    printf("  --bench-rows LISTE     nombres de donnees du benchmark (defaut 10000,100000)\n");
+    printf("  --bench-dims LISTE     dimensions du benchmark (defaut 16,128)\n");
+    printf("  --bench-neurons LISTE  tailles de carte du benchmark (defaut 100,400)\n");
+    printf("  --bench-epochs LISTE   nombres d'epoques du benchmark (defaut 5)\n");
+    printf("  --bench-threads LISTE  nombres de threads du benchmark (defaut 1 et tous les processeurs)\n");
+    printf("  --sweep FICHIER        entraine toutes les combinaisons des listes --sweep-* en parallele, classement CSV dans FICHIER\n");
+    printf("  --sweep-alpha LISTE    taux d'apprentissage du balayage (defaut : --alpha)\n");
+    printf("  --sweep-epochs LISTE   nombres d'epoques du balayage (defaut : --epochs)\n");
+    printf("  --sweep-neurons LISTE  tailles de carte du balayage (defaut : --neurons)\n");
+    printf("  --threads N            nombre de threads des modes paralleles (defaut : tous les processeurs)\n");
+    printf("  --seed N               graine des tirages aleatoires, pour reproduire une execution hors --hogwild (defaut : l'heure)\n");
 }
 
 
 /**
- * @brief Frees all dynamically allocated memory for the dataset and neural network matrix.
+ * @brief Reads the run configuration from the command line.
  *
- * This function is responsible for releasing all dynamically allocated memory used by the dataset and
- * the neural network matrix. It frees the memory for the mixed indices array (`tabMelanger`), the mean vector (`vecteurMoyen`),
- * as well as the vectors and labels for each dataset element. It also frees the matrix of neurons and their vectors.
- * The function ensures that all memory is properly freed to avoid memory leaks.
+ * Every option is optional; without arguments the program reproduces the original
+ * Iris run. An unknown option or a missing value prints the usage and exits.
  *
- * @param data The dataset containing all the data structures that need to be freed.
- * @param dataMatrice The matrix of neurons, including vectors and labels, that needs to be freed.
+ * @param argc The number of arguments.
+ * @param argv The arguments.
+ * @return The run configuration.
  */
-void freeAll(paramDataset data, ParamMatrice dataMatrice){
-    int i,j;
+ParamExecution lireArguments(int argc, char ** argv){
+    int i;
+    ParamExecution param;
+
+    param.fichier = "iris.data";
+    param.delimiteur = ",";
+    param.alpha = 0.7;
+    param.temps = 500;
+    param.voisinage = VOISINAGE_BULLE;
+    param.batch = 0;
+    param.tailleLot = 1;
+    param.fichierBinaire = NULL;
+    param.nbNeurone = 0;
+    param.flux = 0;
+    param.tailleFenetre = 4096;
+    param.creux = 0;
+    param.rayonLocal = 0;
+    param.abandon = 0;
+    param.ordreVariance = 0;
+    param.triangle = 0;
+    param.hogwild = 0;
+    param.verificationHogwild = 0;
+    param.nbProcessus = 1;
+    param.transport = TRANSPORT_MEMOIRE;
+    param.dimensionEsquisse = 0;
+    param.nbCandidats = 16;
+    param.fichierModele = NULL;
+    param.modele = NULL;
+    param.sortieProjection = NULL;
+    param.fichierBench = NULL;
+    param.fichierStats = NULL;
+    param.graine = (uint64_t)time(NULL);
+    param.fichierBalayage = NULL;
+    param.balayageAlpha.nb = 0;
+    param.balayageEpoques.nb = 0;
+    param.balayageNeurones.nb = 0;
+    param.benchLignes = lireListe("10000,100000");
+    param.benchDimensions = lireListe("16,128");
+    param.benchNeurones = lireListe("100,400");
+    param.benchEpoques = lireListe("5");
+    param.nbThreads = nombreProcesseurs();
+    param.benchThreads.nb = 0;
+
+    for(i=1; i<argc; i++){
+
+        if(strcmp(argv[i], "--stream") == 0){
+            param.flux = 1;
+            continue;
+        }
 
-    free(data.tabMelanger);
-    free(data.vecteurMoyen);
+        if(strcmp(argv[i], "--sparse") == 0){
+            param.creux = 1;
+            continue;
+        }
 
-// free dataset
-    for(i=0; i<data.tailleTab; i++){
+        if(strcmp(argv[i], "--early-abandon") == 0){
+            param.abandon = 1;
+            continue;
+        }
+
+        if(strcmp(argv[i], "--triangle") == 0){
+            param.triangle = 1;
+            continue;
+        }
+
+        if(strcmp(argv[i], "--hogwild") == 0){
+            param.hogwild = 1;
+            continue;
+        }
+
+        if(strcmp(argv[i], "--hogwild-check") == 0){
+            param.hogwild = 1;
+            param.verificationHogwild = 1;
+            continue;
+        }
+
+        if(strcmp(argv[i], "--sort-dimensions") == 0){
+            param.abandon = 1;
+            param.ordreVariance = 1;
+            continue;
+        }
+
+        if(i+1 >= argc){
+            afficherUsage(argv[0]);
+            exit(1);
+        }
+
+        if(strcmp(argv[i], "--data") == 0){
+            param.fichier = argv[++i];
+        }
+        else if(strcmp(argv[i], "--delimiter") == 0){
+            param.delimiteur = argv[++i];
+        }
+        else if(strcmp(argv[i], "--alpha") == 0){
+            param.alpha = strtod(argv[++i], NULL);
+        }
+        else if(strcmp(argv[i], "--epochs") == 0){
+            param.temps = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--neighborhood") == 0){
+            i++;
+
+            if(strcmp(argv[i], "bubble") == 0){
+                param.voisinage = VOISINAGE_BULLE;
+            }
+            else if(strcmp(argv[i], "gaussian") == 0){
+                param.voisinage = VOISINAGE_GAUSSIEN;
+            }
+            else if(strcmp(argv[i], "mexican-hat") == 0){
+                param.voisinage = VOISINAGE_CHAPEAU_MEXICAIN;
+            }
+            else{
+                afficherUsage(argv[0]);
+                exit(1);
+            }
+        }
+        else if(strcmp(argv[i], "--mode") == 0){
+            i++;
+
+            if(strcmp(argv[i], "online") == 0){
+                param.batch = 0;
+            }
+            else if(strcmp(argv[i], "batch") == 0){
+                param.batch = 1;
+            }
+            else{
+                afficherUsage(argv[0]);
+                exit(1);
+            }
+        }
+        else if(strcmp(argv[i], "--minibatch") == 0){
+            param.tailleLot = atoi(argv[++i]);
+
+            if(param.tailleLot < 1){
+                param.tailleLot = 1;
+            }
+        }
+        else if(strcmp(argv[i], "--neurons") == 0){
+            param.nbNeurone = atoi(argv[++i]);
+
+            if(param.nbNeurone < 10){
+                param.nbNeurone = 10;
+            }
+        }
+        else if(strcmp(argv[i], "--window") == 0){
+            param.tailleFenetre = atoi(argv[++i]);
+
+            if(param.tailleFenetre < 1){
+                param.tailleFenetre = 1;
+            }
+        }
+        else if(strcmp(argv[i], "--local-search") == 0){
+            param.rayonLocal = atoi(argv[++i]);
+
+            if(param.rayonLocal < 0){
+                param.rayonLocal = 0;
+            }
+        }
+        else if(strcmp(argv[i], "--sketch") == 0){
+            param.dimensionEsquisse = atoi(argv[++i]);
+
+            if(param.dimensionEsquisse < 0){
+                param.dimensionEsquisse = 0;
+            }
+        }
+        else if(strcmp(argv[i], "--candidates") == 0){
+            param.nbCandidats = atoi(argv[++i]);
+
+            if(param.nbCandidats < 1){
+                param.nbCandidats = 1;
+            }
+        }
+        else if(strcmp(argv[i], "--convert") == 0){
+            param.fichierBinaire = argv[++i];
+        }
+        else if(strcmp(argv[i], "--save-model") == 0){
+            param.fichierModele = argv[++i];
+        }
+        else if(strcmp(argv[i], "--model") == 0){
+            param.modele = argv[++i];
+        }
+        else if(strcmp(argv[i], "--project") == 0){
+            param.sortieProjection = argv[++i];
+        }
+        else if(strcmp(argv[i], "--stats") == 0){
+            param.fichierStats = argv[++i];
+        }
+        else if(strcmp(argv[i], "--bench") == 0){
+            param.fichierBench = argv[++i];
+        }
+        else if(strcmp(argv[i], "--bench-rows") == 0){
+            param.benchLignes = lireListe(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--bench-dims") == 0){
+            param.benchDimensions = lireListe(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--bench-neurons") == 0){
+            param.benchNeurones = lireListe(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--bench-epochs") == 0){
+            param.benchEpoques = lireListe(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--bench-threads") == 0){
+            param.benchThreads = lireListe(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--sweep") == 0){
+            param.fichierBalayage = argv[++i];
+        }
+        else if(strcmp(argv[i], "--sweep-alpha") == 0){
+            param.balayageAlpha = lireListeReels(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--sweep-epochs") == 0){
+            param.balayageEpoques = lireListe(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--sweep-neurons") == 0){
+            param.balayageNeurones = lireListe(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--processes") == 0){
+            param.nbProcessus = atoi(argv[++i]);
+
+            if(param.nbProcessus < 1){
+                param.nbProcessus = 1;
+            }
+            else if(param.nbProcessus > 1){ // regle batch : accumulateurs additionnes entre les processus
+                param.batch = 1;
+            }
+        }
+        else if(strcmp(argv[i], "--transport") == 0){
+            i++;
+
+            if(strcmp(argv[i], "shm") == 0){
+                param.transport = TRANSPORT_MEMOIRE;
+            }
+            else if(strcmp(argv[i], "socket") == 0){
+                param.transport = TRANSPORT_SOCKET;
+            }
+            else{
+                afficherUsage(argv[0]);
+                exit(1);
+            }
+        }
+        else if(strcmp(argv[i], "--seed") == 0){
+            param.graine = strtoull(argv[++i], NULL, 10);
+        }
+        else if(strcmp(argv[i], "--threads") == 0){
+            param.nbThreads = atoi(argv[++i]);
 
-        free(data.mesDataset[i].vecteur);
-        free(data.mesDataset[i].etiquette);
+            if(param.nbThreads < 1){
+                param.nbThreads = 1;
+            }
+        }
+        else{
+            afficherUsage(argv[0]);
+            exit(1);
+        }
     }
 
-    free(data.mesDataset);
+    if(param.benchThreads.nb == 0){ // un thread, puis tous les processeurs
+        param.benchThreads.valeurs[param.benchThreads.nb++] = 1;
 
-// free matrice
-   for(i=0; i<dataMatrice.largeur; i++){
-        for(j=0; j<dataMatrice.longueur; j++){
-               //free(dataMatrice.matrice[i][j].etiquette);
-               free(dataMatrice.matrice[i][j].vecteur);
+        if(param.nbThreads > 1){
+            param.benchThreads.valeurs[param.benchThreads.nb++] = param.nbThreads;
         }
-        free(dataMatrice.matrice[i]);
     }
 
-    free(dataMatrice.matrice);
+    if(param.balayageAlpha.nb == 0){ // sans liste, la valeur de l'execution simple
+        param.balayageAlpha.valeurs[param.balayageAlpha.nb++] = param.alpha;
+    }
+
+    if(param.balayageEpoques.nb == 0){
+        param.balayageEpoques.valeurs[param.balayageEpoques.nb++] = param.temps;
+    }
+
+    if(param.balayageNeurones.nb == 0){
+        param.balayageNeurones.valeurs[param.balayageNeurones.nb++] = param.nbNeurone;
+    }
+
+    return param;
 }
 
 
@@ -1117,34 +7881,230 @@ void freeAll(paramDataset data, ParamMatrice dataMatrice){
 
 
 /*------------------------EXECUTION------------------------*/
-int main(){
+int main(int argc, char ** argv){
     paramDataset data;
     ParamMatrice dataMatrice;
+    ParamExecution param = lireArguments(argc, argv);
+    double erreurQuantification, erreurTopographique, debutModele, debut;
+    double erreurReference, topographiqueReference, dureeReference = 0.0, dureeApprentissage;
+    int * permutation = NULL;
+    int erreur;
+    Modele modele;
+    Instrumentation mesure;
+    Instrumentation * stats = NULL;
+    Generateur generateur = creerGenerateur(param.graine);
+
+    if(verifierGenerateur() != 0){ // les flux des threads reposent sur le saut
+        printf("generateur pseudo-aleatoire incorrect\n");
+        return 1;
+    }
+
+    if(param.fichierBench != NULL){
+        return benchmark(param);
+    }
+
+    if(param.modele != NULL && param.sortieProjection != NULL){
+        return projectionFlux(param);
+    }
+
+    if(param.flux){
+        return entrainementFlux(param);
+    }
+
+    if(param.creux){
+        return entrainementCreux(param);
+    }
+
+    mesure = creerInstrumentation(param.nbThreads);
+
+    if(param.fichierStats != NULL){
+        stats = &mesure;
+    }
+
+    debut = chronometre();
+
+    if(estDatasetBinaire(param.fichier)){
+        data = chargerDatasetBinaire(param.fichier);
+    }
+    else{
+        data = traitementFichier(param.fichier, param.delimiteur, param.nbThreads);
+    }
+
+    mesurerPhase(stats, PHASE_CHARGEMENT, debut);
+    mesure.octetsCharges = tailleFichier(param.fichier);
+    memset(&dataMatrice, 0, sizeof(dataMatrice));
+
+    if(data.tailleTab == 0){
+        libererInstrumentation(mesure);
+        freeAll(data, dataMatrice);
+        return 1;
+    }
+
+    debut = chronometre();
+
+    if(!data.normalise){
+        NormaliserVecteur(data.mesDataset, data.tailleVec, data.tailleTab);
+        data.normalise = 1;
+    }
+
+    mesurerPhase(stats, PHASE_NORMALISATION, debut);
+
+    if(param.fichierBinaire != NULL){ // conversion seulement
+        erreur = ecrireDatasetBinaire(data, param.fichierBinaire) != 0;
+
+        if(erreur){
+            printf("impossible d'ecrire %s\n", param.fichierBinaire);
+        }
+        else{
+            printf("dataset ecrit dans %s\n", param.fichierBinaire);
+        }
+
+        libererInstrumentation(mesure);
+        freeAll(data, dataMatrice);
+        return erreur;
+    }
+
+    if(param.modele != NULL){ // evaluation d'un modele, sans apprentissage
+        debutModele = chronometre();
+        modele = chargerModele(param.modele);
+
+        if(modele.projection == NULL || modele.carte.tailleVec != data.tailleVec){
+            if(modele.projection != NULL){
+                printf("le modele %s attend %d dimensions, les donnees en ont %d\n", param.modele, modele.carte.tailleVec, data.tailleVec);
+            }
+
+            libererModele(modele);
+            libererInstrumentation(mesure);
+            freeAll(data, dataMatrice);
+            return 1;
+        }
+        printf("modele %s : carte %d x %d, %d dimensions, ouvert en %.3f ms\n\n", param.modele,
+               modele.carte.largeur, modele.carte.longueur, modele.carte.tailleVec, 1000.0 * (chronometre() - debutModele));
+        mesurerPhase(stats, PHASE_MODELE, debutModele);
+
+        debut = chronometre();
+        modele.carte.mesure = stats;
+        evaluerModele(data, modele, param.nbThreads, param.tailleLot);
+        mesurerPhase(stats, PHASE_ETIQUETAGE, debut);
+
+        if(stats != NULL && ecrireRapport(stats, param.fichierStats, "evaluation") != 0){
+            printf("impossible d'ecrire %s\n", param.fichierStats);
+        }
+
+        libererInstrumentation(mesure);
+        libererModele(modele);
+        freeAll(data, dataMatrice);
+        return 0;
+    }
 
-    data = traitementFichier("iris.data", ",");
-    NormaliserVecteur(data.mesDataset, data.tailleVec, data.tailleTab);
+    debut = chronometre();
     vecteurMoyen(data.mesDataset, data.tailleVec, data.tailleTab, data.vecteurMoyen);
-    //afficherData(data.tailleTab,data.tailleVec,data.mesDataset);
+    //afficherData(data.tailleTab,data.tailleVec,data.mesDataset,data.dico);
+
+    if(param.fichierBalayage != NULL){ // balayage des hyperparametres sur les donnees chargees une fois
+        mesurerPhase(stats, PHASE_INITIALISATION, debut);
+        debut = chronometre();
+        erreur = balayage(data, param);
+        mesurerPhase(stats, PHASE_APPRENTISSAGE, debut);
 
-    neurone* mesNeurone = genereVecteurDouble(5*sqrt(data.tailleTab), data.tailleVec, 0.3, 0.3, data.vecteurMoyen);
-    //afficherVecteurNeurone(5*sqrt(data.tailleTab) - 5*sqrt(data.tailleTab)/10 ,data.tailleVec,mesNeurone);
+        if(stats != NULL && ecrireRapport(stats, param.fichierStats, "balayage") != 0){
+            printf("impossible d'ecrire %s\n", param.fichierStats);
+        }
+
+        libererInstrumentation(mesure);
+        freeAll(data, dataMatrice);
+        return erreur;
+    }
 
-    dataMatrice = genererMatriceNeurone(dataMatrice, mesNeurone, 5*sqrt(data.tailleTab));
+    dataMatrice = genererMatriceNeurone(dataMatrice, (param.nbNeurone > 0) ? param.nbNeurone : 5*sqrt(data.tailleTab), data.tailleVec);
+    dataMatrice.generateur = &generateur;
+    genereVecteurDouble(dataMatrice, 0.3, 0.3, data.vecteurMoyen);
+    dataMatrice = preparerTableVoisinage(dataMatrice, param.voisinage, RAYON_VOISINAGE_MAX);
+    //afficherVecteurNeurone(dataMatrice.nbNeurone, data.tailleVec, dataMatrice.tailleVecPad, dataMatrice.poids);
     //afficherMatriceNeurone(dataMatrice, data.tailleVec);
 
 
-    data.tabMelanger = indiceMelange(data.mesDataset, data.tailleTab,data.tailleVec);
+    data.tabMelanger = indiceMelange(data.tailleTab, &generateur);
+    dataMatrice.abandon = param.abandon;
+    dataMatrice.mesure = stats;
+
+    if(param.abandon && param.ordreVariance){ // dimensions de plus forte variance en premier
+        permutation = ordreDimensions(data);
+        permuterDimensions(data.donnees, data.tailleTab, data.tailleVecPad, data.tailleVec, permutation, 0);
+        permuterDimensions(dataMatrice.poids, dataMatrice.nbNeurone, dataMatrice.tailleVecPad, data.tailleVec, permutation, 0);
+    }
+
+    mesurerPhase(stats, PHASE_INITIALISATION, debut);
+
+    if(param.hogwild && param.verificationHogwild && !param.batch){ // reference a un thread, depuis le meme etat
+        dureeReference = referenceSequentielle(data, dataMatrice, param, &erreurReference, &topographiqueReference);
+    }
+
+    debut = chronometre();
+
+    if(param.batch && param.nbProcessus > 1){
+        if(entrainementDistribue(data, dataMatrice, param.temps, param.nbProcessus, param.transport, param.tailleLot) != 0){
+            printf("apprentissage multi-processus impossible\n");
+            libererInstrumentation(mesure);
+            freeAll(data, dataMatrice);
+            return 1;
+        }
+    }
+    else if(param.batch){
+        entrainementBatch(data, dataMatrice, param.temps, param.nbThreads, param.tailleLot);
+    }
+    else if(param.hogwild){
+        entrainementHogwild(data, dataMatrice, param.alpha, param.temps, param.nbThreads);
+    }
+    else{
+        rapprochement(data,dataMatrice, param.alpha, param.temps, param.tailleLot, param.rayonLocal, param.triangle,
+                      param.dimensionEsquisse, param.nbCandidats);
+    }
 
+    dureeApprentissage = chronometre() - debut;
 
-    rapprochement(data,dataMatrice, 0.7, 500);
+    if(permutation != NULL){
+        permuterDimensions(data.donnees, data.tailleTab, data.tailleVecPad, data.tailleVec, permutation, 1);
+        permuterDimensions(dataMatrice.poids, dataMatrice.nbNeurone, dataMatrice.tailleVecPad, data.tailleVec, permutation, 1);
+        free(permutation);
+    }
     //printf("\n\n");
     //afficherMatriceNeurone(dataMatrice, data.tailleVec);
 
+    mesurerPhase(stats, PHASE_APPRENTISSAGE, debut);
+    debut = chronometre();
+
+    etiquetageCarte(data, dataMatrice, param.nbThreads, param.tailleLot, &erreurQuantification, &erreurTopographique);
+    mesurerPhase(stats, PHASE_ETIQUETAGE, debut);
+    afficheEtiquette(dataMatrice, data.dico);
+
+    printf("\nerreur de quantification : %f\nerreur topographique : %f\n", erreurQuantification, erreurTopographique);
+
+    if(param.hogwild && param.verificationHogwild && !param.batch){
+        printf("\nreference a 1 thread : erreur de quantification %f, erreur topographique %f, apprentissage en %.3f s\n",
+               erreurReference, topographiqueReference, dureeReference);
+        printf("hogwild a %d thread(s) : erreur de quantification %f (%+.2f %%), apprentissage en %.3f s (x%.2f)\n",
+               param.nbThreads, erreurQuantification, 100.0 * (erreurQuantification - erreurReference) / erreurReference,
+               dureeApprentissage, (dureeApprentissage > 0.0) ? dureeReference / dureeApprentissage : 0.0);
+    }
+
+    if(param.fichierModele != NULL){
+        debut = chronometre();
+
+        if(ecrireModele(dataMatrice, data.vecteurMoyen, data.dico, param.fichierModele) != 0){
+            printf("impossible d'ecrire %s\n", param.fichierModele);
+        }
+        else{
+            printf("modele ecrit dans %s\n", param.fichierModele);
+        }
+        mesurerPhase(stats, PHASE_MODELE, debut);
+    }
 
-    putEtiquette(dataMatrice, data);
-    raccourciEtiquette(dataMatrice);
-    afficheEtiquette(dataMatrice);
+    if(stats != NULL && ecrireRapport(stats, param.fichierStats, param.batch ? "batch" : (param.hogwild ? "hogwild" : "online")) != 0){
+        printf("impossible d'ecrire %s\n", param.fichierStats);
+    }
 
+    libererInstrumentation(mesure);
     freeAll(data,dataMatrice);
 
     return 0;